@@ -1,16 +1,127 @@
 // BigInt.cpp (updated per requirements)
 #include "BigInt.h"
+#include "BigIntStats.h"
 #include <sstream>
 #include <stdexcept>
 #include <algorithm>
 #include <iomanip>
 #include <cassert>
+#include <cstring>
 
 using namespace std;
 
 static const uint64_t BASE = (1ULL << 32);
 static const uint64_t MASK = BASE - 1;
 
+// Backend nhân chọn lúc biên dịch qua CMake (BIGINT_MUL_BACKEND); build thủ công dùng comba
+#if !defined(BIGINT_MUL_BACKEND_SCHOOLBOOK) && !defined(BIGINT_MUL_BACKEND_COMBA)
+#define BIGINT_MUL_BACKEND_COMBA 1
+#endif
+
+const char *bigint_mul_backend()
+{
+#if defined(BIGINT_MUL_BACKEND_SCHOOLBOOK)
+    return "schoolbook";
+#elif defined(BIGINT_MUL_BACKEND_COMBA)
+    return "comba";
+#endif
+}
+
+// ===== Kernel nhân cơ sở: r[0 .. na+nb) = a * b, r không trùng a, b =====
+
+// Quét theo hàng: cộng a[i]*b vào r từ vị trí i
+static inline void mul_schoolbook(uint32_t *r, const uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+{
+    memset(r, 0, (na + nb) * sizeof(uint32_t));
+    for (size_t i = 0; i < na; ++i)
+    {
+        uint64_t carry = 0;
+        uint64_t ai = a[i];
+        for (size_t j = 0; j < nb; ++j)
+        {
+            uint64_t sum = uint64_t(r[i + j]) + ai * b[j] + carry;
+            r[i + j] = uint32_t(sum & MASK);
+            carry = sum >> 32;
+        }
+        // r[i+nb] chưa được cộng gì ở vòng này nên carry không lan xa hơn
+        r[i + nb] = uint32_t(carry);
+    }
+}
+
+// Quét theo cột (Comba): word k của tích là tổng mọi a[i]*b[k-i], cộng dồn trong bộ tích
+// lũy 96 bit nằm trong thanh ghi (lo 64 bit + hi đếm tràn), mỗi word của r ghi đúng một
+// lần và không đọc lại. Hai cột k, k+1 được tính cùng lúc để mỗi a[i] nạp một lần dùng hai
+// lần. Toán hạng 4096 bit chỉ 1 KB nên vừa L1, không cần chia khối thêm.
+static inline void mul_comba(uint32_t *r, const uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+{
+    const size_t n = na + nb;
+    uint64_t lo = 0; // 64 bit thấp của tổng cột hiện tại (đã cộng phần mang từ cột trước)
+    uint64_t hi = 0; // phần tràn khỏi lo (bit 64 trở lên)
+    size_t k = 0;
+    for (; k + 2 < n; k += 2)
+    {
+        // cột k: i trong [max(0, k+1-nb), min(k, na-1)]; cột k+1: [max(0, k+2-nb), min(k+1, na-1)].
+        // Phần chung dùng chung a[i]; mỗi cột có tối đa một số hạng riêng ở hai đầu.
+        uint64_t lo1 = 0, hi1 = 0;
+        size_t c0 = k + 2 > nb ? k + 2 - nb : 0;
+        size_t i1 = k < na ? k : na - 1;
+        if (k + 1 >= nb)
+        {
+            size_t i = k + 1 - nb; // chỉ thuộc cột k
+            uint64_t t0 = uint64_t(a[i]) * b[k - i];
+            lo += t0;
+            hi += lo < t0;
+        }
+        for (size_t i = c0; i <= i1; ++i)
+        {
+            uint64_t ai = a[i];
+            uint64_t t0 = ai * b[k - i];
+            uint64_t t1 = ai * b[k + 1 - i];
+            lo += t0;
+            hi += lo < t0;
+            lo1 += t1;
+            hi1 += lo1 < t1;
+        }
+        if (k + 1 < na)
+        {
+            uint64_t t1 = uint64_t(a[k + 1]) * b[0]; // chỉ thuộc cột k+1
+            lo1 += t1;
+            hi1 += lo1 < t1;
+        }
+        r[k] = uint32_t(lo);
+        // cột k+1 = phần mang của cột k + tổng riêng của nó
+        uint64_t c = (lo >> 32) | (hi << 32);
+        lo1 += c;
+        hi1 += lo1 < c;
+        r[k + 1] = uint32_t(lo1);
+        lo = (lo1 >> 32) | (hi1 << 32);
+        hi = hi1 >> 32;
+    }
+    for (; k < n; ++k)
+    {
+        size_t i0 = k >= nb ? k - nb + 1 : 0;
+        size_t i1 = k < na ? k : na - 1;
+        for (size_t i = i0; i <= i1 && i < na; ++i)
+        {
+            uint64_t t = uint64_t(a[i]) * b[k - i];
+            lo += t;
+            hi += lo < t;
+        }
+        r[k] = uint32_t(lo);
+        lo = (lo >> 32) | (hi << 32);
+        hi >>= 32;
+    }
+}
+
+static inline void mul_kernel(uint32_t *r, const uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+{
+#if defined(BIGINT_MUL_BACKEND_SCHOOLBOOK)
+    mul_schoolbook(r, a, na, b, nb);
+#else
+    mul_comba(r, a, na, b, nb);
+#endif
+}
+
 // ===== Constructors =====
 BigInt::BigInt()
 {
@@ -28,40 +139,24 @@ BigInt::BigInt(const std::string &decimal)
 {
     data.clear();
     data.push_back(0u);
-    // parse thập phân: this = this*10 + digit
+    // parse thập phân: this = this*10 + digit, tại chỗ
     for (char c : decimal)
     {
         if (c < '0' || c > '9')
             continue;
-        // multiply by 10
-        uint64_t carry = 0;
-        for (size_t i = 0; i < data.size(); ++i)
-        {
-            uint64_t cur = uint64_t(data[i]) * 10 + carry;
-            data[i] = uint32_t(cur & MASK);
-            carry = cur >> 32;
-        }
-        while (carry)
-        {
-            data.push_back(uint32_t(carry & MASK));
-            carry >>= 32;
-        }
-        // add digit
-        uint64_t add = uint64_t(c - '0');
-        size_t i = 0;
-        while (add)
-        {
-            if (i >= data.size())
-                data.push_back(0u);
-            uint64_t cur = uint64_t(data[i]) + add;
-            data[i] = uint32_t(cur & MASK);
-            add = cur >> 32;
-            ++i;
-        }
+        mul_add_word(*this, *this, 10u, uint32_t(c - '0'));
     }
     normalize();
 }
 
+BigInt::BigInt(BigIntView view)
+{
+    if (view.len == 0)
+        data.assign(1, 0u);
+    else
+        data.assign(view.limbs, view.limbs + view.len);
+}
+
 // ===== Utility =====
 BigInt &BigInt::normalize()
 {
@@ -76,8 +171,10 @@ BigInt &BigInt::normalize()
 // shift-left by an arbitrary number of bits, return new BigInt
 BigInt BigInt::shl_bits(int bits) const
 {
+    BIGINT_STAT_OP(STAT_SHL, data.size());
     if (bits == 0)
         return *this;
+    BIGINT_STAT_ADD(STAT_ALLOCATIONS, 1);
     int word_shift = bits / 32;
     int bit_shift = bits % 32;
     BigInt r;
@@ -94,6 +191,7 @@ BigInt BigInt::shl_bits(int bits) const
     }
     if (carry)
         r.data.push_back(uint32_t(carry));
+    r.normalize(); // 0 dịch trái vẫn là {0}
     return r;
 }
 
@@ -103,80 +201,129 @@ BigInt BigInt::shr_bits(int bits) const
 {
     if (bits == 0)
         return *this;
-    int word_shift = bits / 32;
-    int bit_shift = bits % 32;
-    if ((int)data.size() <= word_shift)
-        return BigInt(0);
-    BigInt r;
-    r.data.clear();
-    // start from MSW down to word_shift, push_back then reverse for O(n)
-    uint64_t carry = 0;
-    for (int i = int(data.size()) - 1; i >= word_shift; --i)
-    {
-        uint64_t cur = data[i];
-        if (bit_shift == 0)
-        {
-            uint32_t val = uint32_t(cur);
-            r.data.push_back(val);
-        }
-        else
-        {
-            uint64_t low = (cur >> bit_shift) | (carry << (32 - bit_shift));
-            r.data.push_back(uint32_t(low & MASK));
-            carry = cur & ((1ULL << bit_shift) - 1ULL);
-        }
-    }
-    // dữ liệu đang là MSW..LSW; đảo để thành LSW..MSW
-    reverse(r.data.begin(), r.data.end());
-    r.normalize();
+    BIGINT_STAT_ADD(STAT_ALLOCATIONS, 1);
+    BigInt r = *this;
+    r.shr_bits_inplace(bits);
     return r;
 }
 
-bool BigInt::operator==(const BigInt &other) const
+BigInt &BigInt::shr_bits_inplace(int bits)
 {
-    size_t n = max(data.size(), other.data.size());
-    for (size_t i = 0; i < n; ++i)
+    BIGINT_STAT_OP(STAT_SHR, data.size());
+    size_t ws = size_t(bits / 32);
+    int bs = bits % 32;
+    if (ws >= data.size())
+    {
+        data.assign(1, 0u);
+        return *this;
+    }
+    size_t n = data.size() - ws;
+    uint32_t *d = data.data();
+    if (bs == 0)
     {
-        uint32_t a = (i < data.size() ? data[i] : 0u);
-        uint32_t b = (i < other.data.size() ? other.data[i] : 0u);
-        if (a != b)
-            return false;
+        for (size_t i = 0; i < n; ++i)
+            d[i] = d[i + ws];
     }
-    return true;
+    else
+    {
+        for (size_t i = 0; i + 1 < n; ++i)
+            d[i] = (d[i + ws] >> bs) | (d[i + ws + 1] << (32 - bs));
+        d[n - 1] = d[n - 1 + ws] >> bs;
+    }
+    data.resize(n);
+    return normalize();
+}
+
+// ===== Bit queries =====
+size_t BigInt::bit_length() const
+{
+    return BigIntView(*this).bit_length();
+}
+
+bool BigInt::test_bit(size_t i) const
+{
+    return i / 32 < data.size() && ((data[i / 32] >> (i % 32)) & 1u);
+}
+
+size_t BigInt::count_trailing_zeros() const
+{
+    for (size_t i = 0; i < data.size(); ++i)
+        if (data[i])
+            return i * 32 + size_t(__builtin_ctz(data[i]));
+    return 0;
+}
+
+size_t BigInt::popcount() const
+{
+    size_t c = 0;
+    for (uint32_t w : data)
+        c += size_t(__builtin_popcount(w));
+    return c;
+}
+
+BigInt &BigInt::set_bit(size_t i)
+{
+    if (data.size() <= i / 32)
+        data.resize(i / 32 + 1, 0u);
+    data[i / 32] |= 1u << (i % 32);
+    return *this;
+}
+
+int compare(BigIntView a, BigIntView b)
+{
+    // view đã bỏ word 0 ở đầu nên độ dài khác nhau là quyết định được ngay
+    if (a.len != b.len)
+        return a.len < b.len ? -1 : 1;
+    for (size_t i = a.len; i-- > 0;)
+        if (a.limbs[i] != b.limbs[i])
+            return a.limbs[i] < b.limbs[i] ? -1 : 1;
+    return 0;
+}
+
+bool BigInt::operator==(const BigInt &other) const
+{
+    // dạng chuẩn: khác độ dài là khác nhau, cùng độ dài thì so cả khối
+    BigIntView a(*this), b(other);
+    return a.len == b.len && (a.len == 0 || memcmp(a.limbs, b.limbs, a.len * sizeof(uint32_t)) == 0);
 }
 
 bool BigInt::operator<(const BigInt &other) const
 {
-    size_t n = max(data.size(), other.data.size());
-    for (int i = int(n) - 1; i >= 0; --i)
-    {
-        uint32_t a = (i < (int)data.size() ? data[i] : 0u);
-        uint32_t b = (i < (int)other.data.size() ? other.data[i] : 0u);
-        if (a != b)
-            return a < b;
-    }
-    return false;
+    return compare(*this, other) < 0;
 }
 
 // ===== Arithmetic =====
 BigInt BigInt::operator+(const BigInt &other) const
 {
+    BIGINT_STAT_ADD(STAT_ALLOCATIONS, 1);
+    BigIntView a(*this), b(other);
+    if (a.len < b.len)
+        swap(a, b);
     BigInt r;
-    r.data.assign(max(data.size(), other.data.size()), 0);
+    r.data.resize(a.len + 1);
+    uint32_t *out = r.data.data();
+    // vòng chính trên toán hạng ngắn: không rẽ nhánh, không kiểm tra biên
     uint64_t carry = 0;
-    size_t n = r.data.size();
-    for (size_t i = 0; i < n; ++i)
+    size_t i = 0;
+    for (; i < b.len; ++i)
     {
-        uint64_t a = (i < data.size() ? data[i] : 0);
-        uint64_t b = (i < other.data.size() ? other.data[i] : 0);
-        uint64_t s = a + b + carry;
-        r.data[i] = uint32_t(s & MASK);
+        uint64_t s = uint64_t(a.limbs[i]) + b.limbs[i] + carry;
+        out[i] = uint32_t(s);
         carry = s >> 32;
     }
-    if (carry)
+    // đuôi: chỉ còn lan truyền carry, hết carry thì chép nguyên phần còn lại
+    for (; carry && i < a.len; ++i)
     {
-        r.data.push_back(uint32_t(carry));
+        out[i] = a.limbs[i] + 1u;
+        carry = out[i] == 0;
     }
+    if (i < a.len)
+        memcpy(out + i, a.limbs + i, (a.len - i) * sizeof(uint32_t));
+    out[a.len] = uint32_t(carry);
+    if (!carry)
+        r.data.pop_back();
+    if (r.data.empty())
+        r.data.push_back(0u); // 0 + 0
     return r;
 }
 
@@ -184,57 +331,51 @@ BigInt BigInt::operator-(const BigInt &other) const
 {
     // Giả sử *this >= other
     // Nếu không thỏa, đây là underflow (API hiện chỉ hỗ trợ unsigned)
-    assert(!((*this) < other) && "BigInt::operator- underflow: a < b");
+    BIGINT_STAT_ADD(STAT_ALLOCATIONS, 1);
+    BigIntView a(*this), b(other);
+    assert(b.len <= a.len && "BigInt::operator- underflow: a < b");
     BigInt r;
-    r.data.assign(data.size(), 0);
-    int64_t borrow = 0;
-    for (size_t i = 0; i < data.size(); ++i)
+    r.data.resize(a.len);
+    uint32_t *out = r.data.data();
+    uint64_t borrow = 0;
+    size_t i = 0;
+    size_t nb = min(a.len, b.len);
+    for (; i < nb; ++i)
     {
-        int64_t a = data[i];
-        int64_t b = (i < other.data.size() ? other.data[i] : 0);
-        int64_t d = a - b - borrow;
-        if (d < 0)
-        {
-            d += int64_t(BASE);
-            borrow = 1;
-        }
-        else
-        {
-            borrow = 0;
-        }
-        r.data[i] = uint32_t(d & MASK);
+        uint64_t d = uint64_t(a.limbs[i]) - b.limbs[i] - borrow;
+        out[i] = uint32_t(d);
+        borrow = (d >> 63) & 1u;
+    }
+    for (; borrow && i < a.len; ++i)
+    {
+        borrow = a.limbs[i] == 0;
+        out[i] = a.limbs[i] - 1u;
     }
+    if (i < a.len)
+        memcpy(out + i, a.limbs + i, (a.len - i) * sizeof(uint32_t));
+    // borrow cuối khác 0 nghĩa là *this < other
+    assert(!borrow && "BigInt::operator- underflow: a < b");
+    (void)borrow;
     r.normalize();
     return r;
 }
 
 BigInt BigInt::operator*(const BigInt &other) const
 {
-    size_t na = data.size();
-    size_t nb = other.data.size();
+    return multiply(*this, other);
+}
+
+BigInt multiply(BigIntView a, BigIntView b)
+{
+    size_t na = a.len;
+    size_t nb = b.len;
+    BIGINT_STAT_OP(STAT_MUL, na + nb);
+    BIGINT_STAT_ADD(STAT_ALLOCATIONS, 1);
     BigInt r;
-    r.data.assign(na + nb, 0);
-    for (size_t i = 0; i < na; ++i)
-    {
-        uint64_t carry = 0;
-        for (size_t j = 0; j < nb; ++j)
-        {
-            uint64_t cur = uint64_t(data[i]) * uint64_t(other.data[j]);
-            uint64_t sum = uint64_t(r.data[i + j]) + cur + carry;
-            r.data[i + j] = uint32_t(sum & MASK);
-            carry = sum >> 32;
-        }
-        size_t k = i + nb;
-        while (carry)
-        {
-            if (k >= r.data.size())
-                r.data.push_back(0);
-            uint64_t sum = uint64_t(r.data[k]) + carry;
-            r.data[k] = uint32_t(sum & MASK);
-            carry = sum >> 32;
-            ++k;
-        }
-    }
+    if (na == 0 || nb == 0)
+        return r;
+    r.data.resize(na + nb);
+    mul_kernel(r.data.data(), a.limbs, na, b.limbs, nb);
     r.normalize();
     return r;
 }
@@ -249,14 +390,7 @@ BigInt BigInt::operator/(const BigInt &other) const
 BigInt BigInt::operator%(const BigInt &mod) const
 {
     // Use divmod via Knuth D: compute quotient and remainder, return remainder
-    bool zero = true;
-    for (auto w : mod.data)
-        if (w)
-        {
-            zero = false;
-            break;
-        }
-    if (zero)
+    if (BigIntView(mod).is_zero())
         throw runtime_error("mod by zero");
     if (*this < mod)
         return *this;
@@ -266,14 +400,77 @@ BigInt BigInt::operator%(const BigInt &mod) const
     return r;
 }
 
+// Lõi Knuth D trên buffer thô: u có un word (word cao nhất dành cho tràn), v có m >= 2 word
+// với bit cao nhất của v[m-1] đã bật. Sau khi chạy u[0..m) là phần dư (vẫn đang dịch trái
+// như v), các word còn lại của u bằng 0; q (nếu khác nullptr) nhận un - m word thương.
+static void knuth_d(uint32_t *u, size_t un, const uint32_t *v, size_t m, uint32_t *q)
+{
+    size_t k = un - m; // number of quotient words
+    uint64_t v_m1 = v[m - 1];
+    for (int j = int(k) - 1; j >= 0; --j)
+    {
+        // estimate qhat using top two words of u
+        uint64_t numerator = ((uint64_t)u[j + m] << 32) | (uint64_t)u[j + m - 1];
+        uint64_t qhat = numerator / v_m1;
+        uint64_t rhat = numerator % v_m1;
+
+        // correction loop
+        while (qhat >= (1ULL << 32) || (uint64_t)qhat * (uint64_t)v[m - 2] > (((uint64_t)rhat << 32) | (uint64_t)u[j + m - 2]))
+        {
+            qhat -= 1;
+            rhat += v_m1;
+            if (rhat >= (1ULL << 32))
+                break;
+        }
+
+        // multiply v by qhat and subtract from u at position j
+        // borrow có thể vượt 2^32 (p_hi + 1), nên dùng hiệu có dấu 64-bit
+        // và lấy phần cao của nó làm borrow cho word kế tiếp
+        int64_t borrow = 0;
+        int64_t t = 0;
+        for (size_t i = 0; i < m; ++i)
+        {
+            uint64_t p = (uint64_t)qhat * (uint64_t)v[i];
+            t = int64_t(u[j + i]) - borrow - int64_t(p & MASK);
+            u[j + i] = uint32_t(uint64_t(t) & MASK);
+            borrow = int64_t(p >> 32) - (t >> 32);
+        }
+        t = int64_t(u[j + m]) - borrow;
+        u[j + m] = uint32_t(uint64_t(t) & MASK);
+
+        if (t < 0)
+        {
+            // qhat was too big; add back v
+            qhat -= 1;
+            uint64_t carry2 = 0;
+            for (size_t i = 0; i < m; ++i)
+            {
+                uint64_t sum = (uint64_t)u[j + i] + (uint64_t)v[i] + carry2;
+                u[j + i] = uint32_t(sum & MASK);
+                carry2 = sum >> 32;
+            }
+            u[j + m] = uint32_t(((uint64_t)u[j + m] + carry2) & MASK);
+        }
+        if (q)
+            q[j] = uint32_t(qhat & MASK);
+    }
+}
+
 // Compute quotient and remainder: *this / divisor = quotient, remainder
 void BigInt::divmod(const BigInt &divisor, BigInt &quotient, BigInt &remainder) const
 {
+    ::divmod(*this, divisor, quotient, remainder);
+}
+
+void divmod(BigIntView dividend, const BigInt &divisor, BigInt &quotient, BigInt &remainder)
+{
+    BIGINT_STAT_OP(STAT_DIVMOD, dividend.len);
+    // bản sao u, v
+    BIGINT_STAT_ADD(STAT_ALLOCATIONS, 2);
     // Prepare normalized copies so we can detect actual word sizes and avoid
     // calling __builtin_clz on zero.
-    BigInt u = *this;
+    BigInt u(dividend);
     BigInt v = divisor;
-    u.normalize();
     v.normalize();
 
     // handle zero divisor
@@ -327,64 +524,191 @@ void BigInt::divmod(const BigInt &divisor, BigInt &quotient, BigInt &remainder)
     if (quotient.data.empty())
         quotient.data.push_back(0u);
 
-    for (int j = int(k) - 1; j >= 0; --j)
+    knuth_d(u.data.data(), n, v.data.data(), m, quotient.data.data());
+
+    // remainder: shift right s bits
+    u.shr_bits_inplace(s);
+    remainder.data.swap(u.data);
+    remainder.normalize();
+    quotient.normalize();
+}
+
+// ===== Fused primitives =====
+void mul_add_word(BigInt &dst, BigIntView a, uint32_t w, uint32_t c)
+{
+    // a.len <= dst.data.size() khi trùng nhau nên resize không làm mất buffer của a
+    size_t n = a.len;
+    if (dst.data.size() < n)
+        dst.data.resize(n);
+    uint64_t carry = c;
+    for (size_t i = 0; i < n; ++i)
     {
-        // estimate qhat using top two words of u
-        uint64_t numerator = ((uint64_t)u.data[j + m] << 32) | (uint64_t)u.data[j + m - 1];
-        uint64_t v_m1 = v.data[m - 1];
-        uint64_t qhat = numerator / v_m1;
-        uint64_t rhat = numerator % v_m1;
+        uint64_t cur = uint64_t(a.limbs[i]) * w + carry;
+        dst.data[i] = uint32_t(cur & MASK);
+        carry = cur >> 32;
+    }
+    dst.data.resize(n);
+    if (carry || n == 0)
+        dst.data.push_back(uint32_t(carry));
+    dst.normalize(); // w = 0
+}
 
-        // correction loop
-        while (qhat >= (1ULL << 32) || (uint64_t)qhat * (uint64_t)v.data[m - 2] > (((uint64_t)rhat << 32) | (uint64_t)u.data[j + m - 2]))
-        {
-            qhat -= 1;
-            rhat += v_m1;
-            if (rhat >= (1ULL << 32))
-                break;
-        }
+void add_word(BigInt &dst, BigIntView a, uint32_t c)
+{
+    if (a.limbs != dst.data.data())
+        dst.data.assign(a.limbs, a.limbs + a.len);
+    else
+        dst.data.resize(a.len);
+    uint64_t carry = c;
+    for (size_t i = 0; carry && i < dst.data.size(); ++i)
+    {
+        uint64_t cur = uint64_t(dst.data[i]) + carry;
+        dst.data[i] = uint32_t(cur & MASK);
+        carry = cur >> 32;
+    }
+    if (carry || dst.data.empty())
+        dst.data.push_back(uint32_t(carry));
+}
 
-        // multiply v by qhat and subtract from u at position j
-        uint64_t borrow = 0;
-        for (size_t i = 0; i < m; ++i)
+void sub_word(BigInt &dst, BigIntView a, uint32_t c)
+{
+    if (compare(a, c) < 0)
+        throw runtime_error("sub_word: result would be negative");
+    if (a.limbs != dst.data.data())
+        dst.data.assign(a.limbs, a.limbs + a.len);
+    else
+        dst.data.resize(a.len);
+    uint32_t borrow = c;
+    for (size_t i = 0; borrow && i < dst.data.size(); ++i)
+    {
+        uint32_t cur = dst.data[i];
+        dst.data[i] = cur - borrow;
+        borrow = cur < borrow ? 1u : 0u;
+    }
+    dst.normalize();
+}
+
+uint32_t mod_word(BigIntView a, uint32_t m)
+{
+    if (m == 0)
+        throw runtime_error("mod by zero");
+    uint64_t r = 0;
+    for (size_t i = a.len; i-- > 0;)
+        r = ((r << 32) | a.limbs[i]) % m;
+    return uint32_t(r);
+}
+
+int compare(BigIntView a, uint32_t w)
+{
+    if (a.len > 1)
+        return 1;
+    uint32_t v = a.word(0);
+    return v < w ? -1 : (v > w ? 1 : 0);
+}
+
+ModContext::ModContext(const BigInt &modulus) : m_(modulus)
+{
+    m_.normalize();
+    if (m_.data.size() == 1 && m_.data[0] == 0)
+        throw runtime_error("mod by zero");
+    shift_ = __builtin_clz(m_.data.back());
+    v_ = m_.shl_bits(shift_).data;
+}
+
+// prod_[0..product_words) chứa tích; ghi tích mod m vào dst
+void ModContext::reduce_into(BigInt &dst, size_t tn)
+{
+    uint32_t *t = prod_.data();
+    size_t m = v_.size();
+    while (tn > 0 && t[tn - 1] == 0)
+        --tn;
+    if (m == 1)
+    {
+        uint64_t d = m_.data[0], rem = 0;
+        for (size_t i = tn; i-- > 0;)
+            rem = ((rem << 32) | t[i]) % d;
+        dst.data.assign(1, uint32_t(rem));
+        return;
+    }
+    if (tn >= m)
+    {
+        // dịch tích tại chỗ như v_, word tn nhận phần tràn, rồi chỉ lấy phần dư
+        if (shift_)
         {
-            uint64_t p = (uint64_t)qhat * (uint64_t)v.data[i];
-            uint64_t p_lo = p & MASK;
-            uint64_t p_hi = p >> 32;
-            uint64_t cur = (uint64_t)u.data[j + i];
-            uint64_t sub = cur - p_lo - borrow;
-            u.data[j + i] = uint32_t(sub & MASK);
-            borrow = p_hi + ((cur < p_lo + borrow) ? 1ULL : 0ULL);
+            t[tn] = t[tn - 1] >> (32 - shift_);
+            for (size_t i = tn - 1; i > 0; --i)
+                t[i] = (t[i] << shift_) | (t[i - 1] >> (32 - shift_));
+            t[0] <<= shift_;
         }
-        uint64_t cur = (uint64_t)u.data[j + m];
-        uint64_t sub = cur - borrow;
-        u.data[j + m] = uint32_t(sub & MASK);
+        else
+            t[tn] = 0;
+        knuth_d(t, tn + 1, v_.data(), m, nullptr);
+        if (shift_)
+            for (size_t i = 0; i < m; ++i)
+                t[i] = (t[i] >> shift_) | (i + 1 < m ? t[i + 1] << (32 - shift_) : 0u);
+        tn = m;
+    }
+    // tn < m: tích đã nhỏ hơn m
+    dst.data.assign(t, t + tn);
+    dst.normalize();
+}
 
-        if (cur < borrow)
+void mulmod_into(BigInt &dst, BigIntView a, BigIntView b, ModContext &ctx)
+{
+    size_t na = a.len, nb = b.len;
+    BIGINT_STAT_OP(STAT_MULMOD, na + nb);
+    if (na == 0 || nb == 0)
+    {
+        // prod_ còn tích của lần gọi trước: không được rút gọn nó
+        dst.data.assign(1, 0u);
+        return;
+    }
+    if (ctx.prod_.size() < na + nb + 1)
+        ctx.prod_.resize(na + nb + 1);
+    mul_kernel(ctx.prod_.data(), a.limbs, na, b.limbs, nb);
+    ctx.reduce_into(dst, na + nb);
+}
+
+void sqrmod_into(BigInt &dst, BigIntView a, ModContext &ctx)
+{
+    size_t n = a.len;
+    BIGINT_STAT_OP(STAT_MULMOD, 2 * n);
+    if (ctx.prod_.size() < 2 * n + 1)
+        ctx.prod_.resize(2 * n + 1);
+    uint32_t *t = ctx.prod_.data();
+    fill(t, t + 2 * n, 0u);
+    // các tích chéo a[i]*a[j], i < j, mỗi cặp một lần
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t carry = 0;
+        uint64_t ai = a.limbs[i];
+        for (size_t j = i + 1; j < n; ++j)
         {
-            // qhat was too big; add back v
-            qhat -= 1;
-            uint64_t carry2 = 0;
-            for (size_t i = 0; i < m; ++i)
-            {
-                uint64_t sum = (uint64_t)u.data[j + i] + (uint64_t)v.data[i] + carry2;
-                u.data[j + i] = uint32_t(sum & MASK);
-                carry2 = sum >> 32;
-            }
-            u.data[j + m] = uint32_t(((uint64_t)u.data[j + m] + carry2) & MASK);
+            uint64_t sum = uint64_t(t[i + j]) + ai * a.limbs[j] + carry;
+            t[i + j] = uint32_t(sum & MASK);
+            carry = sum >> 32;
         }
-        quotient.data[j] = uint32_t(qhat & MASK);
+        t[i + n] = uint32_t(carry);
     }
-
-    // remainder: shift right s bits
-    remainder = u.shr_bits(s);
-    remainder.normalize();
-    quotient.normalize();
+    // nhân đôi rồi cộng các bình phương a[i]^2 ở vị trí 2i
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t sq = uint64_t(a.limbs[i]) * a.limbs[i];
+        uint64_t lo = (uint64_t(t[2 * i]) << 1) + (sq & MASK) + carry;
+        t[2 * i] = uint32_t(lo & MASK);
+        carry = lo >> 32;
+        uint64_t hi = (uint64_t(t[2 * i + 1]) << 1) + (sq >> 32) + carry;
+        t[2 * i + 1] = uint32_t(hi & MASK);
+        carry = hi >> 32;
+    }
+    ctx.reduce_into(dst, 2 * n);
 }
 
 // ===== Decimal conversion =====
 std::string BigInt::to_decimal() const
 {
+    BIGINT_STAT_OP(STAT_TO_DECIMAL, data.size());
     // Use base 1e9 division to reduce number of divmod iterations
     BigInt zero(0);
     if (*this == zero)
@@ -419,6 +743,40 @@ std::string BigInt::to_decimal() const
     return out;
 }
 
+// ===== Byte conversion =====
+size_t byte_length(BigIntView a)
+{
+    if (a.len == 0)
+        return 0;
+    return (a.len - 1) * 4 + size_t((32 - __builtin_clz(a.limbs[a.len - 1]) + 7) / 8);
+}
+
+void to_bytes(BigIntView a, uint8_t *out, size_t len)
+{
+    if (len < byte_length(a))
+        throw runtime_error("to_bytes: buffer too small");
+    // out[len-1] là byte thấp nhất
+    for (size_t i = 0; i < len; ++i)
+        out[len - 1 - i] = uint8_t(a.word(i / 4) >> (8 * (i % 4)));
+}
+
+std::vector<uint8_t> to_bytes(BigIntView a, size_t len)
+{
+    std::vector<uint8_t> out(len ? len : byte_length(a));
+    to_bytes(a, out.data(), out.size());
+    return out;
+}
+
+BigInt from_bytes(const uint8_t *bytes, size_t len)
+{
+    BigInt r;
+    r.data.assign((len + 3) / 4 + 1, 0u);
+    for (size_t i = 0; i < len; ++i)
+        r.data[i / 4] |= uint32_t(bytes[len - 1 - i]) << (8 * (i % 4));
+    r.normalize();
+    return r;
+}
+
 // ===== I/O =====
 std::istream &operator>>(std::istream &in, BigInt &val)
 {
@@ -5,22 +5,67 @@
 #include <string>
 #include <iostream>
 #include <cstdint>
+#include <cstddef>
+#include <utility>
 
 using namespace std;
 
+class BigInt;
+
+// Khung nhìn chỉ đọc (không sở hữu) lên một dãy word 32-bit little-endian, ví dụ số nằm
+// sẵn trong buffer gói tin hoặc vùng mmap. Các word 0 ở đầu bị bỏ khi dựng view, nên
+// len là độ dài có nghĩa (0 khi giá trị bằng 0). Buffer phải sống lâu hơn view.
+struct BigIntView
+{
+    const uint32_t *limbs = nullptr;
+    size_t len = 0;
+
+    BigIntView() = default;
+    BigIntView(const uint32_t *words, size_t count) : limbs(words), len(count)
+    {
+        while (len > 0 && limbs[len - 1] == 0)
+            --len;
+    }
+    BigIntView(const BigInt &value); // chuyển ngầm định: mọi hàm nhận view đều nhận BigInt
+
+    bool is_zero() const { return len == 0; }
+    // word thứ i, 0 khi vượt quá độ dài
+    uint32_t word(size_t i) const { return i < len ? limbs[i] : 0u; }
+    // số bit có nghĩa (0 khi giá trị bằng 0)
+    size_t bit_length() const { return len ? len * 32 - size_t(__builtin_clz(limbs[len - 1])) : 0; }
+    bool test_bit(size_t i) const { return (word(i / 32) >> (i % 32)) & 1u; }
+};
+
 class BigInt
 {
 public:
     // BigInt cơ chế dynamic-size: vector chứa các word 32-bit ít quan trọng nhất ở index 0.
     // (Trước đây có BIT_SIZE giới hạn; giờ bỏ giới hạn để cho phép mở rộng động.)
+    // Bất biến: data luôn ở dạng chuẩn, tức data.size() là độ dài có nghĩa và word cao nhất
+    // khác 0 (số 0 là {0}). Mọi phép toán trả về dạng chuẩn; code ghi thẳng vào data phải
+    // gọi normalize() trước khi đưa số ra ngoài.
     vector<uint32_t> data; // little-endian: data[0] là 32 bit thấp nhất
 
     // Constructors
     BigInt();                      // =0
     BigInt(uint32_t val);          // khởi tạo từ 32-bit không dấu
     BigInt(const string &decimal); // parse chuỗi thập phân
+    explicit BigInt(BigIntView view); // sao chép các word của view
     BigInt(const BigInt &other) = default;
     BigInt &operator=(const BigInt &other) = default;
+    BigInt(BigInt &&other) noexcept = default;
+    BigInt &operator=(BigInt &&other) noexcept = default;
+
+    // Dựng / gán từ biểu thức trễ (BigIntExpr.h): tính thẳng vào data trong một lượt,
+    // gán lại vào chính toán hạng thì giữ nguyên buffer
+    template <class E, class = decltype(std::declval<const E &>().eval_into(std::declval<BigInt &>()))>
+    BigInt(const E &expr) { expr.eval_into(*this); }
+    template <class E, class = decltype(std::declval<const E &>().eval_into(std::declval<BigInt &>()))>
+    BigInt &operator=(const E &expr)
+    {
+        expr.eval_into(*this);
+        return *this;
+    }
 
     // So sánh
     bool operator==(const BigInt &other) const;
@@ -38,16 +83,23 @@ public:
 
     // Utility
     BigInt &normalize();
+    bool is_normalized() const { return data.size() == 1 || (!data.empty() && data.back() != 0); }
     std::string to_decimal() const;
 
-    // Quick checks and small shifts
-    // (use existing `normalize()`/`== BigInt(0)` and `shr_bits(1)`)
+    // Truy vấn bit: đọc thẳng word bằng builtin, không dịch hay cấp phát
+    size_t bit_length() const;            // 0 khi = 0
+    bool test_bit(size_t i) const;        // bit i (0 khi vượt quá độ dài)
+    size_t count_trailing_zeros() const;  // số bit 0 ở cuối; 0 khi = 0
+    size_t popcount() const;              // số bit 1
+    BigInt &set_bit(size_t i);            // bật bit i, mở rộng nếu cần
 
     // Bit utilities (member versions so they can be reused elsewhere)
     // shift-left by given number of bits, returning a new BigInt
     BigInt shl_bits(int bits) const;
     // shift-right by given number of bits, returning a new BigInt
     BigInt shr_bits(int bits) const;
+    // dịch phải tại chỗ, không cấp phát
+    BigInt &shr_bits_inplace(int bits);
     // Compute quotient and remainder: *this / divisor = quotient, remainder
     void divmod(const BigInt &divisor, BigInt &quotient, BigInt &remainder) const;
 
@@ -55,3 +107,60 @@ public:
     friend istream &operator>>(istream &in, BigInt &val);
     friend ostream &operator<<(ostream &out, const BigInt &val);
 };
+
+inline BigIntView::BigIntView(const BigInt &value) : BigIntView(value.data.data(), value.data.size()) {}
+
+// Các phép chỉ đọc trên view; bản thành viên của BigInt gọi sang các hàm này
+// So sánh: âm / 0 / dương khi a < b / a == b / a > b
+int compare(BigIntView a, BigIntView b);
+// Tích a*b (kết quả đã normalize)
+BigInt multiply(BigIntView a, BigIntView b);
+// dividend / divisor = quotient, remainder; ném runtime_error khi divisor = 0
+void divmod(BigIntView dividend, const BigInt &divisor, BigInt &quotient, BigInt &remainder);
+
+// Dạng byte big-endian (như trên đường truyền). Số byte tối thiểu để biểu diễn a (0 khi a = 0)
+size_t byte_length(BigIntView a);
+// Ghi a vào out đúng len byte, đệm 0 ở đầu; ném runtime_error nếu len < byte_length(a)
+void to_bytes(BigIntView a, uint8_t *out, size_t len);
+// len = 0: dùng byte_length(a)
+std::vector<uint8_t> to_bytes(BigIntView a, size_t len = 0);
+BigInt from_bytes(const uint8_t *bytes, size_t len);
+
+// Ngữ cảnh rút gọn mod m cho các phép "ghi vào đích" bên dưới: giữ sẵn m đã dịch cho
+// Knuth D và buffer tích 2n word, dùng lại qua hàng nghìn vòng lặp của modexp/Miller-Rabin
+// nên không cấp phát thương bỏ đi hay tích tạm mỗi lần. Không an toàn giữa nhiều thread
+// (mỗi thread một ngữ cảnh).
+class ModContext
+{
+public:
+    explicit ModContext(const BigInt &modulus); // ném runtime_error khi modulus = 0
+    const BigInt &modulus() const { return m_; }
+
+private:
+    friend void mulmod_into(BigInt &dst, BigIntView a, BigIntView b, ModContext &ctx);
+    friend void sqrmod_into(BigInt &dst, BigIntView a, ModContext &ctx);
+    void reduce_into(BigInt &dst, size_t product_words);
+
+    BigInt m_;
+    std::vector<uint32_t> v_;    // m dịch trái shift_ bit để bit cao nhất bật
+    int shift_ = 0;
+    std::vector<uint32_t> prod_; // tích đang rút gọn
+};
+
+// dst = a*b mod m; dst được phép trùng a hoặc b, bộ nhớ của dst được giữ lại giữa các lần gọi
+void mulmod_into(BigInt &dst, BigIntView a, BigIntView b, ModContext &ctx);
+// dst = a^2 mod m, tính mỗi tích chéo một lần
+void sqrmod_into(BigInt &dst, BigIntView a, ModContext &ctx);
+// dst = a*w + c; dst được phép trùng a
+void mul_add_word(BigInt &dst, BigIntView a, uint32_t w, uint32_t c);
+// dst = a + c; khi dst trùng a chỉ lan carry, dừng ngay khi hết nhớ
+void add_word(BigInt &dst, BigIntView a, uint32_t c);
+// dst = a - c; dst được phép trùng a; ném runtime_error khi a < c
+void sub_word(BigInt &dst, BigIntView a, uint32_t c);
+// a mod m với m một word; ném runtime_error khi m = 0
+uint32_t mod_word(BigIntView a, uint32_t m);
+// So sánh với một word: âm / 0 / dương, không cấp phát
+int compare(BigIntView a, uint32_t w);
+
+// Tên kernel nhân được chọn lúc biên dịch (CMake: BIGINT_MUL_BACKEND)
+const char *bigint_mul_backend();
@@ -0,0 +1,63 @@
+// BigIntExpr.h
+// Biểu thức trễ cho các chuỗi phép tính ngắn với số một word hay gặp trong code DH:
+//   p = q * 2u + 1u;   n_minus_1 = n - 1u;   q = q + 2u;   if (x == 1u) ...
+// Mỗi biểu thức chỉ giữ view tới toán hạng và các hằng; nó được tính trong một lượt khi
+// gán vào BigInt (đúng một lần cấp phát, hoặc không cấp phát nào khi gán lại vào chính
+// toán hạng và không tràn word). So sánh với một word không dựng BigInt tạm.
+//
+// Biểu thức trỏ vào toán hạng nên không được giữ lại quá câu lệnh: dùng `BigInt x = ...`,
+// không dùng `auto x = ...`.
+#pragma once
+#include <cstdint>
+#include "BigInt.h"
+
+// a * w + c
+struct BigIntMulAddExpr
+{
+    BigIntView a;
+    uint32_t w;
+    uint32_t c;
+
+    void eval_into(BigInt &dst) const
+    {
+        if (w == 1)
+            add_word(dst, a, c);
+        else
+            mul_add_word(dst, a, w, c);
+    }
+};
+
+// a * w; chỉ cộng thêm được một word (thành BigIntMulAddExpr)
+struct BigIntScaleExpr
+{
+    BigIntView a;
+    uint32_t w;
+
+    void eval_into(BigInt &dst) const { mul_add_word(dst, a, w, 0u); }
+};
+
+// a - c (ném runtime_error khi a < c lúc tính)
+struct BigIntSubWordExpr
+{
+    BigIntView a;
+    uint32_t c;
+
+    void eval_into(BigInt &dst) const { sub_word(dst, a, c); }
+};
+
+inline BigIntScaleExpr operator*(const BigInt &a, uint32_t w) { return {a, w}; }
+inline BigIntScaleExpr operator*(uint32_t w, const BigInt &a) { return {a, w}; }
+inline BigIntMulAddExpr operator+(const BigIntScaleExpr &e, uint32_t c) { return {e.a, e.w, c}; }
+inline BigIntMulAddExpr operator+(const BigInt &a, uint32_t c) { return {a, 1u, c}; }
+inline BigIntSubWordExpr operator-(const BigInt &a, uint32_t c) { return {a, c}; }
+
+// So sánh với một word
+inline bool operator==(const BigInt &a, uint32_t w) { return compare(a, w) == 0; }
+inline bool operator!=(const BigInt &a, uint32_t w) { return compare(a, w) != 0; }
+inline bool operator<(const BigInt &a, uint32_t w) { return compare(a, w) < 0; }
+inline bool operator<=(const BigInt &a, uint32_t w) { return compare(a, w) <= 0; }
+inline bool operator>(const BigInt &a, uint32_t w) { return compare(a, w) > 0; }
+inline bool operator>=(const BigInt &a, uint32_t w) { return compare(a, w) >= 0; }
+
+// n mod w cho w một word, không dựng BigInt tạm
+inline uint32_t operator%(const BigInt &a, uint32_t w) { return mod_word(a, w); }
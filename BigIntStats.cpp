@@ -0,0 +1,153 @@
+// BigIntStats.cpp
+#include "BigIntStats.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+#if defined(BIGINT_STATS) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+using namespace std;
+
+const char *bigint_stat_op_name(BigIntStatOp op)
+{
+    switch (op)
+    {
+    case STAT_MUL:
+        return "mul";
+    case STAT_DIVMOD:
+        return "divmod";
+    case STAT_SHL:
+        return "shl_bits";
+    case STAT_SHR:
+        return "shr_bits";
+    case STAT_TO_DECIMAL:
+        return "to_decimal";
+    case STAT_MULMOD:
+        return "mulmod";
+    default:
+        return "?";
+    }
+}
+
+const char *bigint_stat_counter_name(BigIntStatCounter c)
+{
+    switch (c)
+    {
+    case STAT_MR_ROUNDS:
+        return "mr_rounds";
+    case STAT_CANDIDATES_SIEVED:
+        return "candidates_sieved";
+    case STAT_CANDIDATES_TESTED:
+        return "candidates_tested";
+    case STAT_ALLOCATIONS:
+        return "allocations";
+    default:
+        return "?";
+    }
+}
+
+#ifdef BIGINT_STATS
+
+// Bộ đếm toàn cục; relaxed vì chỉ cần tổng cuối, không cần thứ tự giữa các bộ đếm
+struct AtomicOpStats
+{
+    atomic<uint64_t> calls{0};
+    atomic<uint64_t> words{0};
+    atomic<uint64_t> cycles{0};
+};
+
+static AtomicOpStats g_ops[STAT_OP_COUNT];
+static atomic<uint64_t> g_counters[STAT_COUNTER_COUNT];
+
+namespace bigint_stats
+{
+    uint64_t read_cycles()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return uint64_t(chrono::duration_cast<chrono::nanoseconds>(
+                            chrono::steady_clock::now().time_since_epoch())
+                            .count());
+#endif
+    }
+
+    void record_op(BigIntStatOp op, uint64_t words, uint64_t cycles)
+    {
+        AtomicOpStats &s = g_ops[op];
+        s.calls.fetch_add(1, memory_order_relaxed);
+        s.words.fetch_add(words, memory_order_relaxed);
+        s.cycles.fetch_add(cycles, memory_order_relaxed);
+    }
+
+    void add(BigIntStatCounter c, uint64_t n)
+    {
+        g_counters[c].fetch_add(n, memory_order_relaxed);
+    }
+}
+
+bool bigint_stats_enabled() { return true; }
+
+BigIntStatsSnapshot bigint_stats_snapshot()
+{
+    BigIntStatsSnapshot snap;
+    for (int i = 0; i < STAT_OP_COUNT; ++i)
+    {
+        snap.ops[i].calls = g_ops[i].calls.load(memory_order_relaxed);
+        snap.ops[i].words = g_ops[i].words.load(memory_order_relaxed);
+        snap.ops[i].cycles = g_ops[i].cycles.load(memory_order_relaxed);
+    }
+    for (int i = 0; i < STAT_COUNTER_COUNT; ++i)
+        snap.counters[i] = g_counters[i].load(memory_order_relaxed);
+    return snap;
+}
+
+void bigint_stats_reset()
+{
+    for (int i = 0; i < STAT_OP_COUNT; ++i)
+    {
+        g_ops[i].calls.store(0, memory_order_relaxed);
+        g_ops[i].words.store(0, memory_order_relaxed);
+        g_ops[i].cycles.store(0, memory_order_relaxed);
+    }
+    for (int i = 0; i < STAT_COUNTER_COUNT; ++i)
+        g_counters[i].store(0, memory_order_relaxed);
+}
+
+#else
+
+bool bigint_stats_enabled() { return false; }
+
+BigIntStatsSnapshot bigint_stats_snapshot() { return BigIntStatsSnapshot(); }
+
+void bigint_stats_reset() {}
+
+#endif
+
+void bigint_stats_dump(std::ostream &out, const BigIntStatsSnapshot &snap)
+{
+    if (!bigint_stats_enabled())
+    {
+        out << "BigInt stats disabled (build with BIGINT_STATS)\n";
+        return;
+    }
+    char line[160];
+    snprintf(line, sizeof(line), "%-12s %14s %16s %18s %12s\n", "op", "calls", "words", "cycles", "cycles/call");
+    out << line;
+    for (int i = 0; i < STAT_OP_COUNT; ++i)
+    {
+        const BigIntOpStats &s = snap.ops[i];
+        double per_call = s.calls ? double(s.cycles) / double(s.calls) : 0.0;
+        snprintf(line, sizeof(line), "%-12s %14llu %16llu %18llu %12.1f\n", bigint_stat_op_name(BigIntStatOp(i)),
+                 (unsigned long long)s.calls, (unsigned long long)s.words, (unsigned long long)s.cycles, per_call);
+        out << line;
+    }
+    for (int i = 0; i < STAT_COUNTER_COUNT; ++i)
+    {
+        snprintf(line, sizeof(line), "%-20s %14llu\n", bigint_stat_counter_name(BigIntStatCounter(i)),
+                 (unsigned long long)snap.counters[i]);
+        out << line;
+    }
+}
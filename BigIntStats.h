@@ -0,0 +1,84 @@
+// BigIntStats.h
+// Bộ đếm hiệu năng tùy chọn cho BigInt và tìm số nguyên tố an toàn.
+// Bật bằng cách định nghĩa BIGINT_STATS lúc biên dịch (CMake: -DBIGINT_STATS=ON).
+// Khi tắt, các macro BIGINT_STAT_* không sinh ra code nào trên hot path;
+// snapshot luôn trả về toàn số 0.
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+
+// Các phép toán được đo (số lần gọi, số word xử lý, số cycle)
+enum BigIntStatOp
+{
+    STAT_MUL,
+    STAT_DIVMOD,
+    STAT_SHL,
+    STAT_SHR,
+    STAT_TO_DECIMAL,
+    STAT_MULMOD, // mulmod_into / sqrmod_into
+    STAT_OP_COUNT
+};
+
+// Các bộ đếm sự kiện đơn
+enum BigIntStatCounter
+{
+    STAT_MR_ROUNDS,          // số vòng Miller-Rabin (mỗi base là một vòng)
+    STAT_CANDIDATES_SIEVED,  // ứng viên q bị loại bằng sàng số nguyên tố nhỏ
+    STAT_CANDIDATES_TESTED,  // ứng viên q được đưa vào isPrime
+    STAT_ALLOCATIONS,        // số buffer kết quả mà các phép toán BigInt cấp phát
+    STAT_COUNTER_COUNT
+};
+
+struct BigIntOpStats
+{
+    uint64_t calls = 0;
+    uint64_t words = 0;  // tổng số word đầu vào
+    uint64_t cycles = 0; // tổng cycle (TSC trên x86, ns ở nơi khác), tính cả phép con lồng bên trong
+};
+
+struct BigIntStatsSnapshot
+{
+    BigIntOpStats ops[STAT_OP_COUNT];
+    uint64_t counters[STAT_COUNTER_COUNT] = {};
+};
+
+// true nếu được biên dịch với BIGINT_STATS
+bool bigint_stats_enabled();
+// Đọc giá trị hiện tại của mọi bộ đếm (an toàn khi các thread khác đang chạy)
+BigIntStatsSnapshot bigint_stats_snapshot();
+void bigint_stats_reset();
+// In bảng dạng text; thường dùng với snapshot lấy ngay trước đó
+void bigint_stats_dump(std::ostream &out, const BigIntStatsSnapshot &snap);
+const char *bigint_stat_op_name(BigIntStatOp op);
+const char *bigint_stat_counter_name(BigIntStatCounter c);
+
+#ifdef BIGINT_STATS
+namespace bigint_stats
+{
+    uint64_t read_cycles();
+    void record_op(BigIntStatOp op, uint64_t words, uint64_t cycles);
+    void add(BigIntStatCounter c, uint64_t n);
+
+    // Đo một phép toán từ lúc tạo đến khi ra khỏi scope
+    class ScopedOp
+    {
+    public:
+        ScopedOp(BigIntStatOp op, size_t words) : op_(op), words_(words), start_(read_cycles()) {}
+        ~ScopedOp() { record_op(op_, words_, read_cycles() - start_); }
+        ScopedOp(const ScopedOp &) = delete;
+        ScopedOp &operator=(const ScopedOp &) = delete;
+
+    private:
+        BigIntStatOp op_;
+        uint64_t words_;
+        uint64_t start_;
+    };
+}
+
+#define BIGINT_STAT_OP(op, words) bigint_stats::ScopedOp bigint_stat_scope_(op, words)
+#define BIGINT_STAT_ADD(counter, n) bigint_stats::add(counter, n)
+#else
+#define BIGINT_STAT_OP(op, words) ((void)0)
+#define BIGINT_STAT_ADD(counter, n) ((void)0)
+#endif
@@ -0,0 +1,476 @@
+// BigInt_bench.cpp
+// Micro/macro benchmarks cho BigInt và các hàm Diffie-Hellman.
+// Build: cmake target bigint_bench (xem CMakeLists.txt), hoặc thủ công:
+//   g++ -std=c++17 -O2 -DUNIT_TEST BigInt.cpp BigIntStats.cpp ChaCha20.cpp DiffieHellman.cpp BigInt_bench.cpp -o bigint_bench
+//
+// Cách dùng (giống Google Benchmark):
+//   ./bigint_bench                          # chạy tất cả, in bảng ra stdout
+//   ./bigint_bench --filter=modexp          # chỉ chạy benchmark có tên chứa "modexp"
+//   ./bigint_bench --bits=256,2048          # giới hạn kích thước toán hạng
+//   ./bigint_bench --min-time=0.5           # thời gian đo tối thiểu cho mỗi benchmark (giây)
+//   ./bigint_bench --safe-prime-bits=64,128 # kích thước cho generate_safe_prime (chậm)
+//   ./bigint_bench --out=bench.json         # ghi kết quả dạng JSON (ns/op, ops/s)
+//   ./bigint_bench --no-boost               # bỏ baseline Boost cpp_int
+//   ./bigint_bench --stats                  # in bộ đếm BigIntStats sau khi chạy (cần BIGINT_STATS)
+// Mỗi kết quả JSON có "backend" là "BigInt" hoặc "cpp_int" để so sánh với baseline
+// Boost.Multiprecision dùng trong findSafeprimeChatGPT.cpp.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <cstdio>
+#include "BigInt.h"
+#include "BigIntStats.h"
+#include "DiffieHellman.h"
+#include "Montgomery.h"
+#include "NumberTheory.h"
+#include "RemainderTree.h"
+#include "DHGroupStore.h"
+#include "DHValidate.h"
+
+#if !defined(BENCH_NO_BOOST) && __has_include(<boost/multiprecision/cpp_int.hpp>)
+#include <boost/multiprecision/cpp_int.hpp>
+#define BENCH_HAVE_BOOST 1
+using boost::multiprecision::cpp_int;
+#else
+#define BENCH_HAVE_BOOST 0
+#endif
+
+using namespace std;
+
+// ===== Harness =====
+
+// Giá trị "sink" để compiler không loại bỏ phép tính cần đo
+static volatile uint32_t g_sink;
+
+static inline void do_not_optimize(const BigInt &v)
+{
+    g_sink = g_sink + (v.data.empty() ? 0u : v.data[0]);
+}
+
+static inline void do_not_optimize(bool v)
+{
+    g_sink = g_sink + (v ? 1u : 0u);
+}
+
+static inline void do_not_optimize(size_t v)
+{
+    g_sink = g_sink + uint32_t(v);
+}
+
+struct BenchResult
+{
+    string name;
+    string backend;
+    int bits;
+    uint64_t iterations;
+    double ns_per_op;
+    double ops_per_sec;
+};
+
+struct BenchCase
+{
+    string name;    // tên phép toán, ví dụ "mul"
+    string backend; // "BigInt" hoặc "cpp_int"
+    int bits;
+    // Chạy `iters` lần phép toán cần đo
+    function<void(uint64_t iters)> run;
+};
+
+struct BenchOptions
+{
+    string filter;
+    vector<int> bits = {256, 512, 1024, 2048, 4096};
+    vector<int> safe_prime_bits = {32, 64, 128};
+    double min_time = 0.2;
+    string out;
+    bool boost = true;
+    bool stats = false;
+};
+
+// Đo một case: tăng số vòng lặp cho đến khi tổng thời gian >= min_time
+static BenchResult run_case(const BenchCase &c, double min_time)
+{
+    using clock = chrono::steady_clock;
+    uint64_t iters = 1;
+    double elapsed = 0;
+    for (;;)
+    {
+        auto t0 = clock::now();
+        c.run(iters);
+        auto t1 = clock::now();
+        elapsed = chrono::duration<double>(t1 - t0).count();
+        if (elapsed >= min_time || iters >= (1ULL << 40))
+            break;
+        // ước lượng số vòng cần thiết, tăng ít nhất gấp đôi và không quá 100 lần
+        double factor = (elapsed > 0) ? (min_time * 1.4 / elapsed) : 100.0;
+        if (factor < 2.0)
+            factor = 2.0;
+        if (factor > 100.0)
+            factor = 100.0;
+        iters = uint64_t(double(iters) * factor);
+    }
+    BenchResult r;
+    r.name = c.name;
+    r.backend = c.backend;
+    r.bits = c.bits;
+    r.iterations = iters;
+    r.ns_per_op = elapsed * 1e9 / double(iters);
+    r.ops_per_sec = double(iters) / elapsed;
+    return r;
+}
+
+static string json_escape(const string &s)
+{
+    string out;
+    for (char ch : s)
+    {
+        if (ch == '"' || ch == '\\')
+            out += '\\';
+        out += ch;
+    }
+    return out;
+}
+
+static void write_json(ostream &os, const vector<BenchResult> &results)
+{
+    os << "{\n  \"context\": {\n";
+    os << "    \"library\": \"BigInt\",\n";
+    os << "    \"word_bits\": 32,\n";
+    os << "    \"mul_backend\": \"" << bigint_mul_backend() << "\",\n";
+#ifdef NDEBUG
+    os << "    \"build_type\": \"release\",\n";
+#else
+    os << "    \"build_type\": \"debug\",\n";
+#endif
+    os << "    \"boost_baseline\": " << (BENCH_HAVE_BOOST ? "true" : "false") << "\n";
+    os << "  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult &r = results[i];
+        char buf[512];
+        snprintf(buf, sizeof(buf),
+                 "    {\"name\": \"%s/%d\", \"op\": \"%s\", \"backend\": \"%s\", \"bits\": %d, "
+                 "\"iterations\": %llu, \"ns_per_op\": %.3f, \"ops_per_sec\": %.3f}",
+                 json_escape(r.name).c_str(), r.bits, json_escape(r.name).c_str(),
+                 json_escape(r.backend).c_str(), r.bits, (unsigned long long)r.iterations,
+                 r.ns_per_op, r.ops_per_sec);
+        os << buf << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    os << "  ]\n}\n";
+}
+
+// ===== Operand generation =====
+
+// Sinh BigInt ngẫu nhiên có đúng `bits` bit (bit cao nhất = 1)
+static BigInt random_bigint(int bits, mt19937_64 &rng)
+{
+    size_t words = size_t((bits + 31) / 32);
+    BigInt r;
+    r.data.assign(words, 0u);
+    for (size_t i = 0; i < words; ++i)
+        r.data[i] = uint32_t(rng());
+    int top = (bits - 1) % 32;
+    r.data[words - 1] &= (top == 31) ? 0xFFFFFFFFu : ((2u << top) - 1u);
+    r.data[words - 1] |= (1u << top);
+    r.normalize();
+    return r;
+}
+
+static BigInt random_odd_bigint(int bits, mt19937_64 &rng)
+{
+    BigInt r = random_bigint(bits, rng);
+    r.data[0] |= 1u;
+    return r;
+}
+
+#if BENCH_HAVE_BOOST
+static cpp_int to_cpp_int(const BigInt &v)
+{
+    cpp_int r = 0;
+    for (size_t i = v.data.size(); i-- > 0;)
+    {
+        r <<= 32;
+        r += v.data[i];
+    }
+    return r;
+}
+
+static inline void do_not_optimize(const cpp_int &v)
+{
+    g_sink = g_sink + uint32_t(static_cast<uint32_t>(v & 0xFFFFFFFFu));
+}
+#endif
+
+// ===== Benchmark registry =====
+
+static void register_bigint_cases(vector<BenchCase> &cases, int bits)
+{
+    mt19937_64 rng(0xB16B00B5ULL ^ uint64_t(bits));
+    BigInt a = random_bigint(bits, rng);
+    BigInt b = random_bigint(bits, rng);
+    BigInt wide = a * b;                 // dividend 2n bit, giống bước rút gọn trong modexp
+    BigInt mod = random_odd_bigint(bits, rng);
+    BigInt exp = random_bigint(bits, rng);
+    string dec = a.to_decimal();
+    BigInt cand = random_odd_bigint(bits, rng);
+
+    cases.push_back({"mul", "BigInt", bits, [a, b](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(a * b); }});
+    cases.push_back({"divmod", "BigInt", bits, [wide, mod](uint64_t n)
+                     {
+                         BigInt q, r;
+                         for (uint64_t i = 0; i < n; ++i)
+                         {
+                             wide.divmod(mod, q, r);
+                             do_not_optimize(r);
+                         }
+                     }});
+    cases.push_back({"shl_bits", "BigInt", bits, [a](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(a.shl_bits(1)); }});
+    cases.push_back({"shr_bits", "BigInt", bits, [a](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(a.shr_bits(1)); }});
+    cases.push_back({"to_decimal", "BigInt", bits, [a](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(a.to_decimal().size()); }});
+    cases.push_back({"parse", "BigInt", bits, [dec](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(BigInt(dec)); }});
+    cases.push_back({"modexp", "BigInt", bits, [a, exp, mod](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(modular_exponentiation(a, exp, mod)); }});
+    // Cùng toán hạng với modexp nhưng qua Montgomery; fixed_base dùng bảng dựng sẵn của a
+    // (chi phí dựng bảng không tính, giống nhóm được nạp từ DHGroupStore)
+    auto ctx = make_shared<MontgomeryContext>(mod);
+    auto table = make_shared<FixedBaseTable>(build_fixed_base_table(*ctx, a, bits, 4));
+    cases.push_back({"modexp_mont", "BigInt", bits, [ctx, a, exp](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(ctx->pow(a, exp)); }});
+    cases.push_back({"fixed_base_pow", "BigInt", bits, [ctx, table, a, exp](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(fixed_base_pow(*ctx, *table, a, exp)); }});
+    cases.push_back({"gcd", "BigInt", bits, [a, b](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(gcd(a, b)); }});
+    cases.push_back({"mod_inverse", "BigInt", bits, [a, mod](uint64_t n)
+                     {
+                         for (uint64_t i = 0; i < n; ++i)
+                         {
+                             BigInt x = a;
+                             mod_inverse_inplace(x, mod);
+                             do_not_optimize(x);
+                         }
+                     }});
+    cases.push_back({"jacobi", "BigInt", bits, [a, mod](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(size_t(jacobi(a, mod) + 1)); }});
+    // Số dư theo mọi số nguyên tố lẻ < 2000 (bước sàng của generate_safe_prime_random):
+    // cây phần dư so với một lượt chia từng word cho mỗi số nguyên tố
+    {
+        vector<uint32_t> primes;
+        for (uint32_t m = 3; m < 2000; m += 2)
+        {
+            bool prime = true;
+            for (uint32_t d = 3; d * d <= m && prime; d += 2)
+                prime = m % d != 0;
+            if (prime)
+                primes.push_back(m);
+        }
+        auto tree = make_shared<RemainderTree>(primes);
+        cases.push_back({"small_prime_residues", "BigInt", bits, [tree, cand](uint64_t n)
+                         {
+                             vector<uint32_t> out;
+                             for (uint64_t i = 0; i < n; ++i)
+                             {
+                                 tree->residues(cand, out);
+                                 do_not_optimize(size_t(out[0]));
+                             }
+                         }});
+        cases.push_back({"small_prime_residues_naive", "BigInt", bits, [primes, cand](uint64_t n)
+                         {
+                             vector<uint32_t> out(primes.size());
+                             for (uint64_t i = 0; i < n; ++i)
+                             {
+                                 for (size_t k = 0; k < primes.size(); ++k)
+                                 {
+                                     uint64_t r = 0;
+                                     for (size_t w = cand.data.size(); w-- > 0;)
+                                         r = ((r << 32) | cand.data[w]) % primes[k];
+                                     out[k] = uint32_t(r);
+                                 }
+                                 do_not_optimize(size_t(out[0]));
+                             }
+                         }});
+    }
+    cases.push_back({"private_key", "BigInt", bits, [mod](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(generate_private_key(mod)); }});
+    if (bits > 258)
+        cases.push_back({"private_key_short256", "BigInt", bits, [mod](uint64_t n)
+                         { for (uint64_t i = 0; i < n; ++i) do_not_optimize(generate_private_key(mod, 256)); }});
+    // Ứng viên lẻ ngẫu nhiên: phần lớn là hợp số nên đo đường "loại" điển hình khi tìm số nguyên tố
+    cases.push_back({"isPrime", "BigInt", bits, [cand](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(isPrime(cand)); }});
+}
+
+#if BENCH_HAVE_BOOST
+static void register_boost_cases(vector<BenchCase> &cases, int bits)
+{
+    // Cùng seed với register_bigint_cases để hai backend đo trên cùng toán hạng
+    mt19937_64 rng(0xB16B00B5ULL ^ uint64_t(bits));
+    cpp_int a = to_cpp_int(random_bigint(bits, rng));
+    cpp_int b = to_cpp_int(random_bigint(bits, rng));
+    cpp_int wide = a * b;
+    cpp_int mod = to_cpp_int(random_odd_bigint(bits, rng));
+    cpp_int exp = to_cpp_int(random_bigint(bits, rng));
+    string dec = a.str();
+
+    cases.push_back({"mul", "cpp_int", bits, [a, b](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(cpp_int(a * b)); }});
+    cases.push_back({"divmod", "cpp_int", bits, [wide, mod](uint64_t n)
+                     {
+                         cpp_int q, r;
+                         for (uint64_t i = 0; i < n; ++i)
+                         {
+                             boost::multiprecision::divide_qr(wide, mod, q, r);
+                             do_not_optimize(r);
+                         }
+                     }});
+    cases.push_back({"shl_bits", "cpp_int", bits, [a](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(cpp_int(a << 1)); }});
+    cases.push_back({"shr_bits", "cpp_int", bits, [a](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(cpp_int(a >> 1)); }});
+    cases.push_back({"to_decimal", "cpp_int", bits, [a](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(a.str().size()); }});
+    cases.push_back({"parse", "cpp_int", bits, [dec](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(cpp_int(dec)); }});
+    cases.push_back({"modexp", "cpp_int", bits, [a, exp, mod](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(cpp_int(boost::multiprecision::powm(a, exp, mod))); }});
+}
+#endif
+
+// Các thao tác theo nhóm trên nhóm RFC đầu tiên có đúng `bits` bit (nếu có)
+static void register_dh_group_cases(vector<BenchCase> &cases, int bits)
+{
+    for (const string &name : builtin_dh_group_names())
+    {
+        auto group = make_shared<DHGroup>();
+        builtin_dh_group(name, *group);
+        if (group->bits != bits)
+            continue;
+        BigInt key = generate_private_key(group->p);
+        BigInt pub = group->pow_g(key);
+        cases.push_back({"group_pow_g", "BigInt", bits, [group, key](uint64_t n)
+                         { for (uint64_t i = 0; i < n; ++i) do_not_optimize(group->pow_g(key)); }});
+        // Kiểm tra khóa công khai: Jacobi so với lũy thừa B^q
+        cases.push_back({"validate_public", "BigInt", bits, [group, pub](uint64_t n)
+                         { for (uint64_t i = 0; i < n; ++i) do_not_optimize(check_public_value(*group, pub) == DH_KEY_OK); }});
+        cases.push_back({"validate_public_strict", "BigInt", bits, [group, pub](uint64_t n)
+                         { for (uint64_t i = 0; i < n; ++i) do_not_optimize(check_public_value_strict(*group, pub) == DH_KEY_OK); }});
+        return;
+    }
+}
+
+static void register_safe_prime_cases(vector<BenchCase> &cases, int bits)
+{
+    // generate_safe_prime quét tuyến tính từ 2^(bits-2) nên kết quả là tất định;
+    // mỗi lần lặp đo lại toàn bộ quá trình tìm kiếm
+    cases.push_back({"generate_safe_prime", "BigInt", bits, [bits](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(generate_safe_prime(bits)); }});
+    // Điểm xuất phát ngẫu nhiên: thời gian mỗi lần khác nhau, ns/op là trung bình trên
+    // nhiều vùng tìm kiếm độc lập nên ổn định hơn khi tăng --min-time
+    cases.push_back({"generate_safe_prime_random", "BigInt", bits, [bits](uint64_t n)
+                     { for (uint64_t i = 0; i < n; ++i) do_not_optimize(generate_safe_prime_random(bits)); }});
+}
+
+static vector<int> parse_int_list(const string &s)
+{
+    vector<int> out;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ','))
+        if (!item.empty())
+            out.push_back(atoi(item.c_str()));
+    return out;
+}
+
+static bool parse_args(int argc, char **argv, BenchOptions &opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        auto value = [&](const char *prefix) -> const char *
+        {
+            size_t len = string(prefix).size();
+            return arg.compare(0, len, prefix) == 0 ? argv[i] + len : nullptr;
+        };
+        if (const char *v = value("--filter="))
+            opt.filter = v;
+        else if (const char *v = value("--bits="))
+            opt.bits = parse_int_list(v);
+        else if (const char *v = value("--safe-prime-bits="))
+            opt.safe_prime_bits = parse_int_list(v);
+        else if (const char *v = value("--min-time="))
+            opt.min_time = atof(v);
+        else if (const char *v = value("--out="))
+            opt.out = v;
+        else if (arg == "--no-boost")
+            opt.boost = false;
+        else if (arg == "--stats")
+            opt.stats = true;
+        else
+        {
+            cerr << "Unknown option: " << arg << "\n"
+                 << "Usage: " << argv[0]
+                 << " [--filter=S] [--bits=a,b] [--safe-prime-bits=a,b] [--min-time=SEC] [--out=FILE] [--no-boost] [--stats]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions opt;
+    if (!parse_args(argc, argv, opt))
+        return 2;
+
+    vector<BenchCase> cases;
+    for (int bits : opt.bits)
+    {
+        register_bigint_cases(cases, bits);
+        register_dh_group_cases(cases, bits);
+#if BENCH_HAVE_BOOST
+        if (opt.boost)
+            register_boost_cases(cases, bits);
+#endif
+    }
+    for (int bits : opt.safe_prime_bits)
+        register_safe_prime_cases(cases, bits);
+
+    vector<BenchResult> results;
+    printf("%-24s %-8s %6s %12s %16s %16s\n", "benchmark", "backend", "bits", "iterations", "ns/op", "ops/s");
+    for (const BenchCase &c : cases)
+    {
+        string full = c.name + "/" + to_string(c.bits);
+        if (!opt.filter.empty() && full.find(opt.filter) == string::npos)
+            continue;
+        BenchResult r = run_case(c, opt.min_time);
+        results.push_back(r);
+        printf("%-24s %-8s %6d %12llu %16.1f %16.2f\n", c.name.c_str(), c.backend.c_str(), c.bits,
+               (unsigned long long)r.iterations, r.ns_per_op, r.ops_per_sec);
+        fflush(stdout);
+    }
+
+    if (!opt.out.empty())
+    {
+        ofstream f(opt.out);
+        if (!f)
+        {
+            cerr << "Cannot open output file: " << opt.out << "\n";
+            return 1;
+        }
+        write_json(f, results);
+    }
+    if (opt.stats)
+        bigint_stats_dump(cout, bigint_stats_snapshot());
+    return 0;
+}
@@ -0,0 +1,402 @@
+// BigInt_fuzz.cpp
+// Differential fuzzing / property tests: so sánh kết quả BigInt với Boost cpp_int.
+//
+// Hai chế độ:
+//  - Mặc định: chương trình độc lập sinh toán hạng ngẫu nhiên (kèm các trường hợp biên)
+//      ./bigint_fuzz [--iterations=N] [--seed=S] [--max-words=W] [--modexp-every=K]
+//  - libFuzzer (Clang): biên dịch với -DBIGINT_LIBFUZZER -fsanitize=fuzzer
+//      (CMake: -DBIGINT_LIBFUZZER=ON); input của fuzzer được giải mã thành toán hạng.
+// Lỗi đầu tiên được in ra kèm toán hạng dạng hex rồi abort() (libFuzzer coi là crash).
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <boost/multiprecision/cpp_int.hpp>
+#include "BigInt.h"
+#include "BigIntExpr.h"
+#include "DiffieHellman.h"
+#include "Montgomery.h"
+#include "NumberTheory.h"
+
+using namespace std;
+using boost::multiprecision::cpp_int;
+
+static cpp_int to_cpp_int(const BigInt &v)
+{
+    cpp_int r = 0;
+    for (size_t i = v.data.size(); i-- > 0;)
+    {
+        r <<= 32;
+        r += v.data[i];
+    }
+    return r;
+}
+
+static string hex_of(const BigInt &v)
+{
+    string s = "0x";
+    char buf[16];
+    for (size_t i = v.data.size(); i-- > 0;)
+    {
+        snprintf(buf, sizeof(buf), "%08x", v.data[i]);
+        s += buf;
+    }
+    return s;
+}
+
+static void fail(const char *op, const BigInt &a, const BigInt &b, const cpp_int &got, const cpp_int &expected)
+{
+    cerr << "MISMATCH in " << op << "\n"
+         << "  a        = " << hex_of(a) << " (" << a.data.size() << " words)\n"
+         << "  b        = " << hex_of(b) << " (" << b.data.size() << " words)\n"
+         << "  got      = " << std::hex << got << "\n"
+         << "  expected = " << expected << std::dec << "\n";
+    std::abort();
+}
+
+static void check(const char *op, const BigInt &a, const BigInt &b, const BigInt &got, const cpp_int &expected)
+{
+    cpp_int g = to_cpp_int(got);
+    if (g != expected)
+        fail(op, a, b, g, expected);
+}
+
+static bool is_zero(const BigInt &v)
+{
+    for (uint32_t w : v.data)
+        if (w)
+            return false;
+    return true;
+}
+
+// Ký hiệu Jacobi tham chiếu trên cpp_int (thuật toán chia thông thường), n lẻ > 0
+static int jacobi_ref(cpp_int a, cpp_int n)
+{
+    int t = 1;
+    a %= n;
+    while (a != 0)
+    {
+        while ((a & 1) == 0)
+        {
+            a >>= 1;
+            int n8 = int(n & 7);
+            if (n8 == 3 || n8 == 5)
+                t = -t;
+        }
+        swap(a, n);
+        if ((a & 3) == 3 && (n & 3) == 3)
+            t = -t;
+        a %= n;
+    }
+    return n == 1 ? t : 0;
+}
+
+// Kiểm tra toàn bộ các phép toán nhị phân trên một cặp toán hạng
+static void check_pair(const BigInt &a, const BigInt &b, bool with_modexp)
+{
+    cpp_int A = to_cpp_int(a), B = to_cpp_int(b);
+
+    if ((a == b) != (A == B))
+        fail("operator==", a, b, cpp_int(a == b), cpp_int(A == B));
+    if ((a < b) != (A < B))
+        fail("operator<", a, b, cpp_int(a < b), cpp_int(A < B));
+
+    check("operator+", a, b, a + b, A + B);
+    if (A >= B)
+        check("operator-", a, b, a - b, A - B);
+    else
+        check("operator-", b, a, b - a, B - A);
+    check("operator*", a, b, a * b, A * B);
+
+    // truy vấn bit so với cpp_int
+    if (!is_zero(a))
+    {
+        size_t msb = boost::multiprecision::msb(A), lsb = boost::multiprecision::lsb(A), ones = 0;
+        for (cpp_int t = A; t != 0; t &= t - 1)
+            ++ones;
+        if (a.bit_length() != msb + 1 || a.count_trailing_zeros() != lsb || !a.test_bit(msb) || a.popcount() != ones)
+            fail("bit queries", a, b, cpp_int(a.bit_length()), cpp_int(msb + 1));
+        BigInt sh = a;
+        sh.shr_bits_inplace(int(lsb) + 3);
+        check("shr_bits_inplace", a, b, sh, A >> (lsb + 3));
+    }
+
+    // biểu thức trễ với toán hạng một word (lấy từ word thấp của b)
+    {
+        uint32_t w = b.data[0], c = b.data.back();
+        check("a*w+c", a, b, BigInt(a * w + c), A * w + c);
+        BigInt t = a;
+        t = t + c;
+        check("a+c in place", a, b, t, A + c);
+        if (A >= c)
+            check("a-c", a, b, BigInt(a - c), A - c);
+        if ((a < w) != (A < w) || (a == w) != (A == w) || (w != 0 && cpp_int(a % w) != A % w))
+            fail("compare/mod with word", a, b, cpp_int(a % (w | 1u)), A % (w | 1u));
+    }
+
+    // mọi kết quả phải ở dạng chuẩn (bất biến của BigInt)
+    {
+        BigInt sum = a + b, diff = A >= B ? a - b : b - a, prod = a * b;
+        if (!sum.is_normalized() || !diff.is_normalized() || !prod.is_normalized())
+            fail("normalized result", a, b, cpp_int(0), cpp_int(1));
+    }
+
+    // view trên buffer có word 0 thừa ở đầu phải cho cùng kết quả
+    vector<uint32_t> padded = a.data;
+    padded.resize(padded.size() + 2, 0u);
+    BigIntView av(padded.data(), padded.size());
+    if ((compare(av, b) < 0) != (A < B))
+        fail("compare(view)", a, b, cpp_int(compare(av, b) < 0), cpp_int(A < B));
+    check("multiply(view)", a, b, multiply(av, b), A * B);
+    vector<uint8_t> bytes = to_bytes(av, byte_length(av) + 1);
+    check("to_bytes/from_bytes", a, b, from_bytes(bytes.data(), bytes.size()), A);
+
+    if (!is_zero(b))
+    {
+        BigInt q, r;
+        a.divmod(b, q, r);
+        check("divmod quotient", a, b, q, A / B);
+        check("divmod remainder", a, b, r, A % B);
+        check("operator%", a, b, a % b, A % B);
+        ModContext ctx(b);
+        BigInt dst;
+        mulmod_into(dst, a, a, ctx);
+        check("mulmod_into", a, b, dst, (A * A) % B);
+        sqrmod_into(dst, a, ctx);
+        check("sqrmod_into", a, b, dst, (A * A) % B);
+        // cùng ctx cho nhiều lần gọi: scratch còn tích cũ, toán hạng 0 không được đọc lại nó
+        mulmod_into(dst, a, b, ctx);
+        check("mulmod_into(reused ctx)", a, b, dst, (A * B) % B);
+        mulmod_into(dst, BigInt(0), a, ctx);
+        check("mulmod_into(0, a)", a, b, dst, cpp_int(0));
+        mulmod_into(dst, a, BigInt(0), ctx);
+        check("mulmod_into(a, 0)", a, b, dst, cpp_int(0));
+        sqrmod_into(dst, BigInt(0), ctx);
+        check("sqrmod_into(0)", a, b, dst, cpp_int(0));
+        mulmod_into(dst, a, a, ctx);
+        check("mulmod_into(after zero)", a, b, dst, (A * A) % B);
+    }
+
+    cpp_int G = boost::multiprecision::gcd(A, B);
+    check("gcd", a, b, gcd(a, b), G);
+    if (B > 1)
+    {
+        BigInt inv = a;
+        bool ok = mod_inverse_inplace(inv, b);
+        if (ok != (G == 1))
+            fail("mod_inverse (invertible?)", a, b, cpp_int(ok), cpp_int(G == 1));
+        if (ok)
+            check("mod_inverse", a, b, BigInt((a * inv) % b), cpp_int(1));
+    }
+    if (B & 1)
+    {
+        int j = jacobi(a, b);
+        int jr = jacobi_ref(A, B);
+        if (j != jr)
+            fail("jacobi", a, b, cpp_int(j + 1), cpp_int(jr + 1));
+    }
+
+    int shift = int(B % 97);
+    check("shl_bits", a, BigInt(uint32_t(shift)), a.shl_bits(shift), A << shift);
+    check("shr_bits", a, BigInt(uint32_t(shift)), a.shr_bits(shift), A >> shift);
+
+    string dec = a.to_decimal();
+    if (dec != A.str())
+        fail("to_decimal", a, b, cpp_int(dec.size()), cpp_int(A.str().size()));
+    check("parse", a, b, BigInt(dec), A);
+
+    if (with_modexp && !is_zero(b))
+    {
+        // số mũ ngắn để mỗi vòng vẫn nhanh; modulus là b
+        BigInt e;
+        e.data.assign(a.data.begin(), a.data.begin() + min<size_t>(a.data.size(), 2));
+        e.normalize();
+        check("modular_exponentiation", a, b, modular_exponentiation(a, e, b),
+              boost::multiprecision::powm(A, to_cpp_int(e), B));
+        if ((b.data[0] & 1u) && BigInt(1) < b)
+            check("MontgomeryContext::pow", a, b, MontgomeryContext(b).pow(a, e),
+                  boost::multiprecision::powm(A, to_cpp_int(e), B));
+    }
+}
+
+// ===== Operand generation =====
+
+enum Shape
+{
+    SHAPE_RANDOM,
+    SHAPE_ALL_ONES,     // mọi word = 0xFFFFFFFF
+    SHAPE_SPARSE,       // vài bit rải rác
+    SHAPE_TOP_BIT,      // word cao nhất có đúng bit 31 (divmod không cần dịch chuẩn hóa)
+    SHAPE_TOP_LOW,      // word cao nhất nhỏ (dịch chuẩn hóa gần 31 bit)
+    SHAPE_HIGH_ONES,    // các word cao là 0xFFFFFFFF, word thấp ngẫu nhiên (qhat phải hiệu chỉnh)
+    SHAPE_POW2_EDGE,    // 2^k - 1, 2^k, 2^k + 1
+    SHAPE_COUNT
+};
+
+static uint32_t rand_word(mt19937_64 &rng) { return uint32_t(rng()); }
+
+static BigInt make_operand(mt19937_64 &rng, size_t words, int shape)
+{
+    BigInt v;
+    v.data.assign(words, 0u);
+    switch (shape)
+    {
+    case SHAPE_RANDOM:
+        for (auto &w : v.data)
+            w = rand_word(rng);
+        break;
+    case SHAPE_ALL_ONES:
+        for (auto &w : v.data)
+            w = 0xFFFFFFFFu;
+        break;
+    case SHAPE_SPARSE:
+        for (int k = int(rng() % 4); k >= 0; --k)
+            v.data[rng() % words] |= 1u << (rng() % 32);
+        break;
+    case SHAPE_TOP_BIT:
+        for (auto &w : v.data)
+            w = rand_word(rng);
+        v.data[words - 1] = 0x80000000u | uint32_t(rng() % 4);
+        break;
+    case SHAPE_TOP_LOW:
+        for (auto &w : v.data)
+            w = rand_word(rng);
+        v.data[words - 1] = 1u + uint32_t(rng() % 3);
+        break;
+    case SHAPE_HIGH_ONES:
+        for (size_t i = 0; i < words; ++i)
+            v.data[i] = (i + 2 >= words) ? 0xFFFFFFFFu - uint32_t(rng() % 2) : rand_word(rng);
+        break;
+    case SHAPE_POW2_EDGE:
+    {
+        size_t k = rng() % (words * 32);
+        v.data[k / 32] = 1u << (k % 32);
+        int kind = int(rng() % 3);
+        BigInt p2 = v;
+        p2.normalize();
+        if (kind == 0 && !is_zero(p2))
+            v = p2 - BigInt(1);
+        else if (kind == 1)
+            v = p2 + BigInt(1);
+        break;
+    }
+    }
+    // đôi khi giữ word 0 ở đầu để kiểm tra đường xử lý chưa normalize
+    if (rng() % 8 != 0)
+        v.normalize();
+    return v;
+}
+
+// Số bị chia dạng b*q + r với r < b: tạo thương có word 0xFFFFFFFF và dư sát b,
+// là vùng mà bước hiệu chỉnh qhat / add-back của Knuth D dễ sai
+static BigInt make_structured_dividend(mt19937_64 &rng, const BigInt &b, size_t qwords)
+{
+    BigInt q = make_operand(rng, qwords, (rng() % 2) ? SHAPE_ALL_ONES : SHAPE_HIGH_ONES);
+    BigInt bn = b;
+    bn.normalize();
+    BigInt r = is_zero(bn) ? BigInt(0) : (bn - BigInt(1));
+    if (rng() % 2)
+        r = r.shr_bits(int(rng() % 8));
+    return bn * q + r;
+}
+
+// Các cặp cố định: 0, 1, biên word, modulus 1
+static void run_fixed_edges()
+{
+    const char *values[] = {"0", "1", "2", "4294967295", "4294967296", "4294967297",
+                            "18446744073709551615", "18446744073709551616",
+                            "340282366920938463463374607431768211455"};
+    for (const char *x : values)
+        for (const char *y : values)
+            check_pair(BigInt(string(x)), BigInt(string(y)), true);
+}
+
+static void run_random(uint64_t iterations, uint64_t seed, size_t max_words, uint64_t modexp_every)
+{
+    mt19937_64 rng(seed);
+    for (uint64_t it = 0; it < iterations; ++it)
+    {
+        size_t wa = 1 + rng() % max_words;
+        size_t wb = 1 + rng() % max_words;
+        BigInt a = make_operand(rng, wa, int(rng() % SHAPE_COUNT));
+        BigInt b = make_operand(rng, wb, int(rng() % SHAPE_COUNT));
+        bool modexp = modexp_every && (it % modexp_every == 0);
+        check_pair(a, b, modexp);
+        if (!is_zero(b))
+            check_pair(make_structured_dividend(rng, b, 1 + rng() % max_words), b, false);
+    }
+}
+
+// ===== libFuzzer entry =====
+
+#ifdef BIGINT_LIBFUZZER
+// Giải mã input: byte 0 = số word của a (mod 64), sau đó là các word của a rồi của b
+static void operands_from_bytes(const uint8_t *data, size_t size, BigInt &a, BigInt &b)
+{
+    a.data.clear();
+    b.data.clear();
+    if (size == 0)
+    {
+        a = BigInt(0);
+        b = BigInt(0);
+        return;
+    }
+    size_t wa = data[0] % 64;
+    ++data;
+    --size;
+    size_t total = size / 4;
+    for (size_t i = 0; i < total; ++i)
+    {
+        uint32_t w;
+        memcpy(&w, data + 4 * i, 4);
+        (i < wa ? a.data : b.data).push_back(w);
+    }
+    // word 0 ở đầu do fuzzer sinh phải bỏ: mọi BigInt ở dạng chuẩn
+    a.normalize();
+    b.normalize();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    BigInt a, b;
+    operands_from_bytes(data, size, a, b);
+    check_pair(a, b, a.data.size() <= 8 && b.data.size() <= 8);
+    return 0;
+}
+#else
+int main(int argc, char **argv)
+{
+    uint64_t iterations = 20000;
+    uint64_t seed = 20240501;
+    size_t max_words = 24;
+    uint64_t modexp_every = 16;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg.rfind("--iterations=", 0) == 0)
+            iterations = strtoull(arg.c_str() + 13, nullptr, 10);
+        else if (arg.rfind("--seed=", 0) == 0)
+            seed = strtoull(arg.c_str() + 7, nullptr, 10);
+        else if (arg.rfind("--max-words=", 0) == 0)
+            max_words = size_t(strtoull(arg.c_str() + 12, nullptr, 10));
+        else if (arg.rfind("--modexp-every=", 0) == 0)
+            modexp_every = strtoull(arg.c_str() + 15, nullptr, 10);
+        else
+        {
+            cerr << "Usage: " << argv[0] << " [--iterations=N] [--seed=S] [--max-words=W] [--modexp-every=K]\n";
+            return 2;
+        }
+    }
+    if (max_words == 0)
+        max_words = 1;
+    cout << "Running BigInt differential fuzz: iterations=" << iterations << " seed=" << seed
+         << " max_words=" << max_words << "\n";
+    run_fixed_edges();
+    run_random(iterations, seed, max_words, modexp_every);
+    cout << "All fuzz checks passed.\n";
+    return 0;
+}
+#endif
@@ -4,8 +4,11 @@
 #include <cassert>
 #include <string>
 #include "BigInt.h"
+#include "BigIntExpr.h"
 #include <random>
 #include <cstdlib>
+#include <vector>
+#include <stdexcept>
 
 using namespace std;
 
@@ -23,6 +26,16 @@ static void expect_eq(const BigInt &v, const string &dec, const char *msg)
     }
 }
 
+static void expect_true(bool cond, const char *msg)
+{
+    if (!cond)
+    {
+        cerr << "FAIL: " << msg << "\n";
+        exit(1);
+    }
+    cout << "ok: " << msg << "\n";
+}
+
 int main()
 {
     cout << "Running BigInt tests...\n";
@@ -130,6 +143,154 @@ int main()
 
     // 15) (skipped) set_bit >= BIT_SIZE ignored - set_bit/membership not available
 
+    // 16) Knuth D multi-word divisor where qhat * v[i] + borrow exceeds one word
+    BigInt kd_a(string("17350579898077527581690781050847292429194995523951638527812404666634186922924"));
+    BigInt kd_m(string("74064948247946814551128711532129928800383003845178056907449609013024789301245"));
+    BigInt kd_sq = kd_a * kd_a;
+    expect_eq(kd_sq / kd_m, string("4064576158100769563806411129852709876539483545550727756489634333801278553070"), "Knuth D quotient (multi-word borrow)");
+    expect_eq(kd_sq % kd_m, string("48857884857072554910925137891986933896126589930130680803107380047601567137626"), "Knuth D remainder (multi-word borrow)");
+
+    // 17) BigIntView over an external word buffer (leading zero words ignored)
+    {
+        uint32_t wire[4] = {0x89abcdefu, 0x01234567u, 0u, 0u};
+        BigIntView v(wire, 4);
+        BigInt owned(v);
+        expect_true(v.len == 2 && owned.data.size() == 2, "view trims leading zero words");
+        expect_eq(owned, "81985529216486895", "BigInt copied from view");
+        expect_true(compare(v, BigInt(string("81985529216486895"))) == 0, "compare view with BigInt");
+        expect_true(compare(v, BigInt(string("81985529216486896"))) < 0, "compare view less");
+        expect_true(compare(BigIntView(wire, 1), v) < 0 && compare(BigIntView(), BigInt(0)) == 0, "compare shorter view and zero view");
+        expect_eq(multiply(v, v), "6721627000907426263151485706741025", "multiply from views");
+        BigInt q, r;
+        divmod(v, BigInt(1000000007u), q, r);
+        expect_eq(q, "81985528", "divmod quotient from view dividend");
+        expect_eq(r, "642588199", "divmod remainder from view dividend");
+    }
+
+    // 18) big-endian byte round trip
+    {
+        BigInt x(string("81985529216486895"));
+        vector<uint8_t> b = to_bytes(x);
+        expect_true(b.size() == 8 && b[0] == 0x01 && b[7] == 0xef, "to_bytes minimal length");
+        vector<uint8_t> padded = to_bytes(x, 12);
+        expect_true(padded.size() == 12 && padded[0] == 0 && padded[4] == 0x01, "to_bytes padded");
+        expect_true(from_bytes(padded.data(), padded.size()) == x && from_bytes(b.data(), b.size()) == x, "from_bytes round trip");
+        expect_true(byte_length(BigInt(0)) == 0 && to_bytes(BigInt(0)).empty() && byte_length(BigInt(256u)) == 2, "byte_length edge cases");
+        bool threw = false;
+        try
+        {
+            uint8_t small[4];
+            to_bytes(x, small, 4);
+        }
+        catch (const std::runtime_error &)
+        {
+            threw = true;
+        }
+        expect_true(threw, "to_bytes throws on short buffer");
+    }
+
+    // 19) fused primitives write into a reused destination
+    {
+        BigInt m(string("74064948247946814551128711532129928800383003845178056907449609013024789301245"));
+        BigInt a(string("17350579898077527581690781050847292429194995523951638527812404666634186922924"));
+        ModContext ctx(m);
+        BigInt dst;
+        sqrmod_into(dst, a, ctx);
+        expect_eq(dst, "48857884857072554910925137891986933896126589930130680803107380047601567137626", "sqrmod_into");
+        mulmod_into(dst, a, a, ctx);
+        expect_eq(dst, "48857884857072554910925137891986933896126589930130680803107380047601567137626", "mulmod_into");
+        const uint32_t *buf = dst.data.data();
+        mulmod_into(dst, dst, BigInt(1), ctx); // trùng đích, không cấp phát lại
+        expect_true(dst.data.data() == buf, "mulmod_into keeps destination buffer");
+        ModContext small(BigInt(97u));
+        mulmod_into(dst, a, a, small);
+        expect_eq(dst, to_string(int((a % BigInt(97u)).data[0] * (a % BigInt(97u)).data[0] % 97)), "mulmod_into single-word modulus");
+        BigInt x(4294967295u);
+        mul_add_word(x, x, 4294967295u, 4294967295u);
+        expect_eq(x, "18446744069414584320", "mul_add_word in place");
+    }
+
+    // 20) results stay normalized; subtraction borrows through zero words
+    {
+        BigInt two64 = BigInt(1).shl_bits(64);
+        BigInt d = two64 - BigInt(1);
+        expect_true(d.data.size() == 2 && d.is_normalized(), "subtraction result normalized");
+        expect_eq(d, "18446744073709551615", "borrow across zero words");
+        expect_true((d + BigInt(1)).data.size() == 3 && d + BigInt(1) == two64, "carry grows a word");
+        expect_true((two64 - two64).data.size() == 1 && (two64 - two64) == BigInt(0), "x - x is zero");
+        expect_true((BigInt(0) + BigInt(0)).data.size() == 1 && BigInt(0).shl_bits(40).is_normalized(), "zero sums and shifts normalized");
+        expect_true(!(two64 == d) && d < two64 && !(two64 < d), "comparison after borrow");
+    }
+
+    // 21) bit queries without shifting
+    {
+        BigInt x(0);
+        x.set_bit(0).set_bit(33).set_bit(100);
+        expect_true(x.bit_length() == 101 && x.popcount() == 3 && x.data.size() == 4, "set_bit grows, bit_length, popcount");
+        expect_true(x.test_bit(33) && !x.test_bit(32) && !x.test_bit(5000), "test_bit");
+        expect_true(x.count_trailing_zeros() == 0 && (x - BigInt(1)).count_trailing_zeros() == 33, "count_trailing_zeros");
+        expect_true(BigInt(0).bit_length() == 0 && BigInt(0).count_trailing_zeros() == 0 && BigInt(0).popcount() == 0,
+                    "bit queries on zero");
+        BigInt y = x;
+        y.shr_bits_inplace(33);
+        expect_true(y == x.shr_bits(33) && y.bit_length() == 68 && y.is_normalized(), "shr_bits_inplace matches shr_bits");
+        y.shr_bits_inplace(200);
+        expect_true(y == BigInt(0) && y.data.size() == 1, "shr_bits_inplace past the end");
+    }
+
+    // 22) lazy expressions with one-word operands
+    {
+        BigInt q("340282366920938463463374607431768211455"); // 2^128 - 1
+        BigInt p = q * 2u + 1u;
+        expect_eq(p, "680564733841876926926749214863536422911", "q*2u+1u fused");
+        expect_true(p == q * BigInt(2) + BigInt(1) && p.is_normalized(), "fused chain matches BigInt arithmetic");
+        q = q + 2u;
+        expect_true(q.data.size() == 5 && q == BigInt(1).shl_bits(128) + BigInt(1), "add_word carries out of the top word");
+        q = q - 2u;
+        expect_eq(q, "340282366920938463463374607431768211455", "sub_word borrows through zero words");
+        expect_true(q.is_normalized() && q.data.size() == 4, "sub_word result normalized");
+        BigInt r = q - 100u, r0 = r;
+        const uint32_t *buf = r.data.data();
+        r = r + 7u;
+        r = r - 7u;
+        expect_true(r == r0 && r.data.data() == buf, "in-place add/sub without carry-out keep the buffer");
+        BigInt s = q * 3u;
+        expect_true(s == q * BigInt(3) && BigInt(BigInt(0) + 0u).is_normalized() && BigInt(BigInt(5) - 5u) == 0u,
+                    "scale and zero results");
+        bool threw = false;
+        try
+        {
+            BigInt t = BigInt(3) - 4u;
+        }
+        catch (const runtime_error &)
+        {
+            threw = true;
+        }
+        expect_true(threw, "sub_word underflow throws");
+        expect_true(q > 3u && !(q < 3u) && q != 3u && BigInt(3) == 3u && BigInt(3) <= 3u && BigInt(2) < 3u,
+                    "compare with a word");
+        expect_true(q % 5u == 0 && q % 7u == uint32_t((q % BigInt(7)).data[0]) && BigInt(0) % 3u == 0, "mod by a word");
+    }
+
+    // 23) one ModContext reused across calls, including zero operands
+    {
+        BigInt m(string("74064948247946814551128711532129928800383003845178056907449609013024789301245"));
+        BigInt a(string("17350579898077527581690781050847292429194995523951638527812404666634186922924"));
+        ModContext ctx(m);
+        BigInt dst;
+        mulmod_into(dst, a, a, ctx); // để lại tích khác 0 trong scratch của ctx
+        mulmod_into(dst, BigInt(0), a, ctx);
+        expect_true(dst == 0u && dst.is_normalized(), "mulmod_into 0 * b after a previous call");
+        mulmod_into(dst, a, a, ctx);
+        mulmod_into(dst, a, BigInt(0), ctx);
+        expect_true(dst == 0u && dst.is_normalized(), "mulmod_into a * 0 after a previous call");
+        mulmod_into(dst, a, a, ctx);
+        sqrmod_into(dst, BigInt(0), ctx);
+        expect_true(dst == 0u && dst.is_normalized(), "sqrmod_into 0 after a previous call");
+        mulmod_into(dst, a, BigInt(3), ctx);
+        expect_true(dst == (a * BigInt(3)) % m, "mulmod_into after zero operands");
+    }
+
     cout << "All tests passed.\n";
     std::_Exit(0);
 }
@@ -0,0 +1,105 @@
+// ChaCha20.cpp
+#include "ChaCha20.h"
+#include <random>
+#include <cstring>
+
+using namespace std;
+
+static inline uint32_t rotl32(uint32_t x, int n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+#define CHACHA_QR(a, b, c, d) \
+    a += b;                   \
+    d = rotl32(d ^ a, 16);    \
+    c += d;                   \
+    b = rotl32(b ^ c, 12);    \
+    a += b;                   \
+    d = rotl32(d ^ a, 8);     \
+    c += d;                   \
+    b = rotl32(b ^ c, 7)
+
+void chacha20_block(const uint32_t key[8], const uint32_t input[4], uint32_t out[16])
+{
+    // "expand 32-byte k"
+    uint32_t s[16] = {0x61707865u, 0x3320646eu, 0x79622d32u, 0x6b206574u,
+                      key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+                      input[0], input[1], input[2], input[3]};
+    uint32_t x[16];
+    memcpy(x, s, sizeof(x));
+    for (int i = 0; i < 10; ++i)
+    {
+        // column rounds
+        CHACHA_QR(x[0], x[4], x[8], x[12]);
+        CHACHA_QR(x[1], x[5], x[9], x[13]);
+        CHACHA_QR(x[2], x[6], x[10], x[14]);
+        CHACHA_QR(x[3], x[7], x[11], x[15]);
+        // diagonal rounds
+        CHACHA_QR(x[0], x[5], x[10], x[15]);
+        CHACHA_QR(x[1], x[6], x[11], x[12]);
+        CHACHA_QR(x[2], x[7], x[8], x[13]);
+        CHACHA_QR(x[3], x[4], x[9], x[14]);
+    }
+    for (int i = 0; i < 16; ++i)
+        out[i] = x[i] + s[i];
+}
+
+#undef CHACHA_QR
+
+ChaCha20Rng::ChaCha20Rng()
+{
+    random_device rd;
+    for (auto &k : key_)
+        k = uint32_t(rd());
+    stream_ = (uint64_t(rd()) << 32) | rd();
+}
+
+ChaCha20Rng::ChaCha20Rng(const uint32_t key[8], uint64_t stream)
+{
+    memcpy(key_, key, sizeof(key_));
+    stream_ = stream;
+}
+
+void ChaCha20Rng::refill()
+{
+    uint32_t input[4] = {uint32_t(counter_), uint32_t(counter_ >> 32), uint32_t(stream_), uint32_t(stream_ >> 32)};
+    chacha20_block(key_, input, buf_);
+    ++counter_;
+    pos_ = 0;
+}
+
+uint32_t ChaCha20Rng::next_u32()
+{
+    if (pos_ == 16)
+        refill();
+    return buf_[pos_++];
+}
+
+ChaCha20Rng::result_type ChaCha20Rng::operator()()
+{
+    uint64_t lo = next_u32();
+    return lo | (uint64_t(next_u32()) << 32);
+}
+
+void ChaCha20Rng::fill(uint32_t *out, size_t n)
+{
+    while (n > 0)
+    {
+        if (pos_ == 16)
+            refill();
+        size_t take = 16 - pos_;
+        if (take > n)
+            take = n;
+        memcpy(out, buf_ + pos_, take * sizeof(uint32_t));
+        pos_ += take;
+        out += take;
+        n -= take;
+    }
+}
+
+ChaCha20Rng &ChaCha20Rng::thread_local_instance()
+{
+    thread_local ChaCha20Rng rng;
+    return rng;
+}
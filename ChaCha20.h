@@ -0,0 +1,43 @@
+// ChaCha20.h
+// DRBG dựa trên block function ChaCha20 (RFC 7539) ở chế độ counter.
+// Mỗi thread dùng một instance riêng (thread_local_instance), seed một lần từ
+// std::random_device, nên sinh khóa không phải tạo random_device/mt19937_64 mỗi lần gọi.
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+// Block function ChaCha20: key 8 word, input = word 12..15 của state
+// (RFC 7539: counter 32-bit + nonce 96-bit), kết quả 16 word
+void chacha20_block(const uint32_t key[8], const uint32_t input[4], uint32_t out[16]);
+
+class ChaCha20Rng
+{
+public:
+    // UniformRandomBitGenerator để dùng được với <random>
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    // Seed từ std::random_device
+    ChaCha20Rng();
+    // Seed xác định (dùng cho test / tái lập kết quả)
+    ChaCha20Rng(const uint32_t key[8], uint64_t stream);
+
+    uint32_t next_u32();
+    result_type operator()();
+    // Ghi n word ngẫu nhiên vào out
+    void fill(uint32_t *out, size_t n);
+
+    // Instance riêng của thread hiện tại
+    static ChaCha20Rng &thread_local_instance();
+
+private:
+    void refill();
+
+    uint32_t key_[8];
+    uint64_t counter_ = 0; // word 12..13
+    uint64_t stream_ = 0;  // word 14..15
+    uint32_t buf_[16];
+    size_t pos_ = 16; // vị trí word tiếp theo trong buf_; 16 = cần sinh block mới
+};
@@ -0,0 +1,149 @@
+// DHAsync.cpp
+#include "DHAsync.h"
+#include "DHValidate.h"
+#include "DiffieHellman.h"
+
+using namespace std;
+
+static uint64_t nanos_between(chrono::steady_clock::time_point a, chrono::steady_clock::time_point b)
+{
+    return uint64_t(chrono::duration_cast<chrono::nanoseconds>(b - a).count());
+}
+
+DHComputePool::DHComputePool(const DHGroup &group) : DHComputePool(group, Options())
+{
+}
+
+DHComputePool::DHComputePool(const DHGroup &group, Options options)
+    : group_(group), options_(std::move(options))
+{
+    size_t threads = options_.threads;
+    if (threads == 0)
+        threads = thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    if (options_.max_queue == 0)
+        options_.max_queue = 1;
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+        workers_.emplace_back([this]
+                              { worker_loop(); });
+}
+
+DHComputePool::~DHComputePool()
+{
+    {
+        lock_guard<mutex> lk(mu_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto &t : workers_)
+        t.join();
+}
+
+bool DHComputePool::enqueue(Job *job)
+{
+    job->enqueued = chrono::steady_clock::now();
+    {
+        lock_guard<mutex> lk(mu_);
+        if (stopping_ || queue_.size() >= options_.max_queue)
+        {
+            rejected_.fetch_add(1, memory_order_relaxed);
+            job->error = make_exception_ptr(DHOverloadError());
+            return false;
+        }
+        queue_.push_back(job);
+        queue_depth_.store(queue_.size(), memory_order_relaxed);
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void DHComputePool::worker_loop()
+{
+    for (;;)
+    {
+        Job *job;
+        {
+            unique_lock<mutex> lk(mu_);
+            cv_.wait(lk, [this]
+                     { return stopping_ || !queue_.empty(); });
+            if (queue_.empty())
+                return; // stopping_ và đã chạy hết việc đã nhận
+            job = queue_.front();
+            queue_.pop_front();
+            queue_depth_.store(queue_.size(), memory_order_relaxed);
+        }
+        finish(job);
+    }
+}
+
+void DHComputePool::finish(Job *job)
+{
+    running_.fetch_add(1, memory_order_relaxed);
+    auto start = chrono::steady_clock::now();
+    queue_wait_.record(nanos_between(job->enqueued, start));
+    try
+    {
+        job->run();
+        completed_.fetch_add(1, memory_order_relaxed);
+    }
+    catch (...)
+    {
+        job->error = current_exception();
+        failed_.fetch_add(1, memory_order_relaxed);
+    }
+    auto end = chrono::steady_clock::now();
+    service_.record(nanos_between(start, end));
+    total_.record(nanos_between(job->enqueued, end));
+    running_.fetch_sub(1, memory_order_relaxed);
+
+    // Sau dòng này job có thể đã bị hủy (nằm trong frame coroutine) nên không đụng tới nữa
+    coroutine_handle<> h = job->handle;
+    if (options_.resume)
+        options_.resume(h);
+    else
+        h.resume();
+}
+
+DHComputePool::Op<DHKeyPair> DHComputePool::generate_keypair()
+{
+    const DHGroup *g = &group_;
+    int bits = options_.exponent_bits;
+    return submit([g, bits]
+                  {
+                      DHKeyPair kp;
+                      kp.private_key = generate_private_key(g->p, bits);
+                      kp.public_key = g->pow_g(kp.private_key);
+                      return kp; });
+}
+
+DHComputePool::Op<BigInt> DHComputePool::derive(const BigInt &peer, const BigInt &priv)
+{
+    const DHGroup *g = &group_;
+    bool validate = options_.validate_peer;
+    return submit([g, validate, peer, priv]
+                  {
+                      if (validate)
+                      {
+                          DHKeyCheck r = check_public_value(*g, peer);
+                          if (r != DH_KEY_OK)
+                              throw runtime_error(string("DH peer public value rejected: ") + dh_key_check_name(r));
+                      }
+                      return g->pow(peer, priv); });
+}
+
+DHComputePool::Stats DHComputePool::stats() const
+{
+    Stats s;
+    s.threads = workers_.size();
+    s.queue_depth = queue_depth_.load(memory_order_relaxed);
+    s.running = running_.load(memory_order_relaxed);
+    s.completed = completed_.load(memory_order_relaxed);
+    s.failed = failed_.load(memory_order_relaxed);
+    s.rejected = rejected_.load(memory_order_relaxed);
+    s.queue_wait = queue_wait_.snapshot();
+    s.service = service_.snapshot();
+    s.total = total_.snapshot();
+    return s;
+}
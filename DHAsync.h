@@ -0,0 +1,166 @@
+// DHAsync.h
+// API Diffie-Hellman cho coroutine C++20: các phép lũy thừa chạy trên pool tính toán riêng,
+// thread reactor chỉ co_await và không bao giờ chặn trên modexp.
+//
+//     DHComputePool dh(group, {.threads = 4, .max_queue = 256});
+//     DHKeyPair kp = co_await dh.generate_keypair();
+//     BigInt secret = co_await dh.derive(peer_public, kp.private_key);
+//
+// Giới hạn song song = số thread của pool. Backpressure: khi số việc đang chờ đạt max_queue,
+// co_await không treo mà ném DHOverloadError ngay, để server từ chối/trì hoãn request thay
+// vì xếp hàng vô hạn; saturated() cho reactor biết để ngừng đọc socket sớm hơn.
+// Coroutine được tiếp tục trên thread tính toán, hoặc qua Options::resume (ví dụ đẩy
+// handle về event loop của reactor).
+#pragma once
+#include <coroutine>
+#include <functional>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <type_traits>
+#include "BigInt.h"
+#include "DHGroupStore.h"
+#include "LatencyHistogram.h"
+
+struct DHKeyPair
+{
+    BigInt private_key;
+    BigInt public_key;
+};
+
+// Hàng đợi đầy: request bị từ chối trước khi vào pool
+class DHOverloadError : public std::runtime_error
+{
+public:
+    DHOverloadError() : std::runtime_error("DH compute queue is full") {}
+};
+
+class DHComputePool
+{
+public:
+    struct Options
+    {
+        size_t threads = 0;        // 0: số core
+        size_t max_queue = 1024;   // số việc chờ tối đa (chưa tính việc đang chạy)
+        int exponent_bits = 0;     // > 0: short exponent cho generate_keypair
+        bool validate_peer = true; // derive kiểm tra khóa công khai (check_public_value)
+        // Nơi tiếp tục coroutine khi xong; rỗng: tiếp tục ngay trên thread tính toán
+        std::function<void(std::coroutine_handle<>)> resume = nullptr;
+    };
+
+    struct Stats
+    {
+        size_t threads;
+        size_t queue_depth; // việc đang chờ
+        size_t running;     // việc đang chạy
+        uint64_t completed;
+        uint64_t failed;    // ném exception (ví dụ khóa công khai không hợp lệ)
+        uint64_t rejected;  // bị từ chối vì hàng đợi đầy
+        LatencyHistogram::Snapshot queue_wait; // từ lúc co_await tới lúc bắt đầu chạy
+        LatencyHistogram::Snapshot service;    // thời gian chạy trên pool
+        LatencyHistogram::Snapshot total;      // từ lúc co_await tới lúc có kết quả (trước khi tiếp tục)
+    };
+
+    // Việc tính toán đã xóa kiểu, do awaitable cấp phát và sở hữu
+    struct Job
+    {
+        std::function<void()> run;
+        std::coroutine_handle<> handle;
+        std::chrono::steady_clock::time_point enqueued;
+        std::exception_ptr error;
+    };
+
+    // T = void: việc không có kết quả, co_await chỉ chờ xong (hoặc ném lỗi của việc)
+    template <class T>
+    class Op
+    {
+    public:
+        Op(DHComputePool *pool, std::function<T()> fn) : pool_(pool), fn_(std::move(fn)) {}
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            job_.run = [this]
+            {
+                if constexpr (std::is_void_v<T>)
+                    fn_();
+                else
+                    result_.emplace(fn_());
+            };
+            job_.handle = h;
+            // false: không treo (bị từ chối), await_resume ném DHOverloadError
+            return pool_->enqueue(&job_);
+        }
+        T await_resume()
+        {
+            if (job_.error)
+                std::rethrow_exception(job_.error);
+            if constexpr (!std::is_void_v<T>)
+                return std::move(*result_);
+        }
+
+    private:
+        struct NoResult
+        {
+        };
+        using Result = std::conditional_t<std::is_void_v<T>, NoResult, T>;
+
+        DHComputePool *pool_;
+        std::function<T()> fn_;
+        std::optional<Result> result_;
+        Job job_;
+    };
+
+    explicit DHComputePool(const DHGroup &group);
+    DHComputePool(const DHGroup &group, Options options);
+    // Chờ các việc đã nhận chạy xong rồi dừng thread
+    ~DHComputePool();
+
+    DHComputePool(const DHComputePool &) = delete;
+    DHComputePool &operator=(const DHComputePool &) = delete;
+
+    const DHGroup &group() const { return group_; }
+
+    // Khóa riêng + khóa công khai g^x (bảng lũy thừa cố định của nhóm)
+    Op<DHKeyPair> generate_keypair();
+    // Bí mật chung peer^priv mod p; ném runtime_error nếu peer không hợp lệ
+    Op<BigInt> derive(const BigInt &peer, const BigInt &priv);
+    // Việc tùy ý trên pool (kể cả hàm trả về void), dùng chung hàng đợi, giới hạn và thống kê
+    template <class F>
+    auto submit(F fn) -> Op<decltype(fn())>
+    {
+        return Op<decltype(fn())>(this, std::function<decltype(fn())()>(std::move(fn)));
+    }
+
+    bool saturated() const { return queue_depth_.load(std::memory_order_relaxed) >= options_.max_queue; }
+    Stats stats() const;
+
+private:
+    bool enqueue(Job *job);
+    void worker_loop();
+    void finish(Job *job);
+
+    DHGroup group_;
+    Options options_;
+    std::vector<std::thread> workers_;
+    std::deque<Job *> queue_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+
+    std::atomic<size_t> queue_depth_{0};
+    std::atomic<size_t> running_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> rejected_{0};
+    LatencyHistogram queue_wait_;
+    LatencyHistogram service_;
+    LatencyHistogram total_;
+};
@@ -0,0 +1,241 @@
+// DHAsync_test.cpp
+// Tests for the coroutine DH API: results, errors, backpressure, resume hook and stats
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <coroutine>
+#include "BigInt.h"
+#include "DiffieHellman.h"
+#include "DHGroupStore.h"
+#include "DHAsync.h"
+#include "LatencyHistogram.h"
+
+using namespace std;
+
+static void expect_true(bool cond, const char *msg)
+{
+    if (!cond)
+    {
+        cerr << "FAIL: " << msg << "\n";
+        exit(1);
+    }
+    else
+        cout << "ok: " << msg << "\n";
+}
+
+// Coroutine tối giản chạy ngay, tự hủy khi xong (kiểu "detached task" của reactor)
+struct Detached
+{
+    struct promise_type
+    {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+template <class F>
+static bool wait_until(F cond)
+{
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(30);
+    while (chrono::steady_clock::now() < deadline)
+    {
+        if (cond())
+            return true;
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    return cond();
+}
+
+static Detached exchange(DHComputePool &dh, atomic<int> &ok, atomic<int> &done)
+{
+    DHKeyPair alice = co_await dh.generate_keypair();
+    DHKeyPair bob = co_await dh.generate_keypair();
+    BigInt s1 = co_await dh.derive(bob.public_key, alice.private_key);
+    BigInt s2 = co_await dh.derive(alice.public_key, bob.private_key);
+    const DHGroup &g = dh.group();
+    if (s1 == s2 && s1 == modular_exponentiation(bob.public_key, alice.private_key, g.p))
+        ++ok;
+    ++done;
+}
+
+static Detached bad_peer(DHComputePool &dh, atomic<int> &threw)
+{
+    try
+    {
+        co_await dh.derive(BigInt(1), BigInt(12345));
+    }
+    catch (const runtime_error &)
+    {
+        ++threw;
+    }
+}
+
+static Detached blocking_job(DHComputePool &dh, atomic<bool> &release, atomic<int> &done)
+{
+    co_await dh.submit([&release]
+                       {
+                           while (!release.load())
+                               this_thread::yield();
+                           return 0; });
+    ++done;
+}
+
+static Detached maybe_rejected(DHComputePool &dh, atomic<int> &rejected, atomic<int> &done)
+{
+    try
+    {
+        co_await dh.submit([]
+                           { return 1; });
+        ++done;
+    }
+    catch (const DHOverloadError &)
+    {
+        ++rejected;
+    }
+}
+
+static Detached on_reactor(DHComputePool &dh, thread::id &resumed_on, atomic<int> &done)
+{
+    co_await dh.generate_keypair();
+    resumed_on = this_thread::get_id();
+    ++done;
+}
+
+static Detached void_job(DHComputePool &dh, atomic<int> &ran, atomic<int> &threw, atomic<int> &done)
+{
+    co_await dh.submit([&ran]
+                       { ++ran; });
+    try
+    {
+        co_await dh.submit([]
+                           { throw runtime_error("job failed"); });
+    }
+    catch (const runtime_error &)
+    {
+        ++threw;
+    }
+    ++done;
+}
+
+int main()
+{
+    // 0) histogram buckets and percentiles
+    {
+        LatencyHistogram h;
+        for (uint64_t v = 1; v <= 1000; ++v)
+            h.record(v * 1000);
+        auto s = h.snapshot();
+        uint64_t p50 = s.percentile_ns(0.5), p99 = s.percentile_ns(0.99);
+        expect_true(s.count == 1000 && s.max_ns == 1000000, "histogram count and max");
+        expect_true(p50 >= 500000 && p50 <= 500000 + 500000 / 16 + 1, "p50 within one bucket");
+        expect_true(p99 >= 990000 && p99 <= 1000000, "p99 within one bucket");
+        bool mono = true;
+        for (int i = 1; i < LatencyHistogram::BUCKETS; ++i)
+            mono = mono && LatencyHistogram::bucket_upper(i) > LatencyHistogram::bucket_upper(i - 1);
+        for (uint64_t v : {0ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull})
+            mono = mono && v <= LatencyHistogram::bucket_upper(LatencyHistogram::bucket_of(v));
+        expect_true(mono, "bucket bounds are monotonic and contain their values");
+    }
+
+    BigInt p = generate_safe_prime(128);
+    DHGroup group = make_dh_group("safe128", p, default_generator(p));
+
+    // 1) many concurrent exchanges started from this thread without blocking it
+    {
+        DHComputePool dh(group, {.threads = 3, .max_queue = 1024});
+        atomic<int> ok{0}, done{0};
+        const int N = 50;
+        for (int i = 0; i < N; ++i)
+            exchange(dh, ok, done);
+        expect_true(wait_until([&]
+                               { return done.load() == N; }),
+                    "all coroutine exchanges complete");
+        expect_true(ok.load() == N, "shared secrets agree with synchronous modexp");
+        auto st = dh.stats();
+        expect_true(st.completed == uint64_t(4 * N) && st.total.count == uint64_t(4 * N) &&
+                        st.service.count == uint64_t(4 * N) && st.threads == 3,
+                    "stats count every operation");
+        expect_true(st.total.percentile_ns(0.99) >= st.service.percentile_ns(0.5), "latency histograms populated");
+    }
+
+    // 2) invalid peer values surface as exceptions in the coroutine
+    {
+        DHComputePool dh(group, {.threads = 1});
+        atomic<int> threw{0};
+        bad_peer(dh, threw);
+        expect_true(wait_until([&]
+                               { return threw.load() == 1; }),
+                    "invalid peer public value throws");
+        expect_true(dh.stats().failed == 1, "failure counted");
+    }
+
+    // 3) backpressure: one worker busy, queue of 2, the rest rejected without suspending
+    {
+        DHComputePool dh(group, {.threads = 1, .max_queue = 2});
+        atomic<bool> release{false};
+        atomic<int> done{0}, rejected{0};
+        blocking_job(dh, release, done);
+        expect_true(wait_until([&]
+                               { return dh.stats().running == 1; }),
+                    "worker picked up the blocking job");
+        for (int i = 0; i < 5; ++i)
+            maybe_rejected(dh, rejected, done);
+        expect_true(rejected.load() == 3 && dh.saturated() && dh.stats().queue_depth == 2,
+                    "queue bounded at max_queue, overflow rejected immediately");
+        release = true;
+        expect_true(wait_until([&]
+                               { return done.load() == 3; }),
+                    "queued work drains after release");
+        expect_true(dh.stats().rejected == 3 && !dh.saturated(), "rejections counted, pool no longer saturated");
+    }
+
+    // 4) resume hook hands the coroutine back to the reactor thread
+    {
+        mutex mu;
+        vector<coroutine_handle<>> ready;
+        DHComputePool::Options opt;
+        opt.threads = 2;
+        opt.resume = [&](coroutine_handle<> h)
+        {
+            lock_guard<mutex> lk(mu);
+            ready.push_back(h);
+        };
+        DHComputePool dh(group, opt);
+        thread::id resumed_on;
+        atomic<int> done{0};
+        on_reactor(dh, resumed_on, done);
+        // vòng lặp sự kiện giả: tiếp tục các coroutine đã sẵn sàng trên thread này
+        wait_until([&]
+                   {
+                       vector<coroutine_handle<>> batch;
+                       {
+                           lock_guard<mutex> lk(mu);
+                           batch.swap(ready);
+                       }
+                       for (auto h : batch)
+                           h.resume();
+                       return done.load() == 1; });
+        expect_true(done.load() == 1 && resumed_on == this_thread::get_id(), "coroutine resumed on the reactor thread");
+    }
+
+    // 5) jobs returning void: co_await waits for completion and surfaces their exceptions
+    {
+        DHComputePool dh(group, {.threads = 1, .max_queue = 16, .exponent_bits = 0, .validate_peer = true, .resume = nullptr});
+        atomic<int> ran{0}, threw{0}, done{0};
+        void_job(dh, ran, threw, done);
+        expect_true(wait_until([&]
+                               { return done.load() == 1; }) &&
+                        ran.load() == 1 && threw.load() == 1,
+                    "void job runs and its exception reaches the coroutine");
+    }
+
+    cout << "All async DH tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,649 @@
+// DHGroupStore.cpp
+#include "DHGroupStore.h"
+#include "BigIntExpr.h"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+using namespace std;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "DHGroupStore file format assumes a little-endian host"
+#endif
+
+static const char FILE_MAGIC[8] = {'D', 'H', 'G', 'R', 'O', 'U', 'P', 'S'};
+static const uint32_t FILE_VERSION = 2; // 2: thêm checksum vào record header
+static const uint32_t RECORD_MAGIC = 0x52474844u; // "DHGR"
+
+struct GroupFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_bytes;
+};
+
+struct GroupRecordHeader
+{
+    uint32_t magic;
+    uint32_t record_bytes;
+    uint32_t bits;
+    uint32_t words;
+    uint32_t n0inv;
+    uint32_t table_window;
+    uint32_t table_exp_bits;
+    uint32_t table_entries;
+    char name[32];
+    uint32_t checksum_lo; // FNV-1a 64 bit trên header (checksum = 0) và mọi word sau header
+    uint32_t checksum_hi;
+};
+
+static_assert(sizeof(GroupFileHeader) == 16, "unexpected header padding");
+static_assert(sizeof(GroupRecordHeader) == 72, "unexpected record header padding");
+
+// ===== Built-in groups =====
+
+// RFC 3526 (MODP) và RFC 7919 (FFDHE), hex big-endian
+static const struct
+{
+    const char *name;
+    const char *hex;
+} BUILTIN_GROUPS[] = {
+    {"modp1536",
+     "FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74"
+     "020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F1437"
+     "4FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7ED"
+     "EE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF05"
+     "98DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB"
+     "9ED529077096966D670C354E4ABC9804F1746C08CA237327FFFFFFFFFFFFFFFF"},
+    {"modp2048",
+     "FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74"
+     "020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F1437"
+     "4FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7ED"
+     "EE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF05"
+     "98DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB"
+     "9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3B"
+     "E39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF695581718"
+     "3995497CEA956AE515D2261898FA051015728E5A8AACAA68FFFFFFFFFFFFFFFF"},
+    {"modp3072",
+     "FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74"
+     "020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F1437"
+     "4FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7ED"
+     "EE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF05"
+     "98DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB"
+     "9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3B"
+     "E39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF695581718"
+     "3995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33"
+     "A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7"
+     "ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864"
+     "D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E2"
+     "08E24FA074E5AB3143DB5BFCE0FD108E4B82D120A93AD2CAFFFFFFFFFFFFFFFF"},
+    {"modp4096",
+     "FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74"
+     "020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F1437"
+     "4FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7ED"
+     "EE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF05"
+     "98DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB"
+     "9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3B"
+     "E39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF695581718"
+     "3995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33"
+     "A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7"
+     "ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864"
+     "D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E2"
+     "08E24FA074E5AB3143DB5BFCE0FD108E4B82D120A92108011A723C12A787E6D7"
+     "88719A10BDBA5B2699C327186AF4E23C1A946834B6150BDA2583E9CA2AD44CE8"
+     "DBBBC2DB04DE8EF92E8EFC141FBECAA6287C59474E6BC05D99B2964FA090C3A2"
+     "233BA186515BE7ED1F612970CEE2D7AFB81BDD762170481CD0069127D5B05AA9"
+     "93B4EA988D8FDDC186FFB7DC90A6C08F4DF435C934063199FFFFFFFFFFFFFFFF"},
+    {"ffdhe2048",
+     "FFFFFFFFFFFFFFFFADF85458A2BB4A9AAFDC5620273D3CF1D8B9C583CE2D3695"
+     "A9E13641146433FBCC939DCE249B3EF97D2FE363630C75D8F681B202AEC4617A"
+     "D3DF1ED5D5FD65612433F51F5F066ED0856365553DED1AF3B557135E7F57C935"
+     "984F0C70E0E68B77E2A689DAF3EFE8721DF158A136ADE73530ACCA4F483A797A"
+     "BC0AB182B324FB61D108A94BB2C8E3FBB96ADAB760D7F4681D4F42A3DE394DF4"
+     "AE56EDE76372BB190B07A7C8EE0A6D709E02FCE1CDF7E2ECC03404CD28342F61"
+     "9172FE9CE98583FF8E4F1232EEF28183C3FE3B1B4C6FAD733BB5FCBC2EC22005"
+     "C58EF1837D1683B2C6F34A26C1B2EFFA886B423861285C97FFFFFFFFFFFFFFFF"},
+    {"ffdhe3072",
+     "FFFFFFFFFFFFFFFFADF85458A2BB4A9AAFDC5620273D3CF1D8B9C583CE2D3695"
+     "A9E13641146433FBCC939DCE249B3EF97D2FE363630C75D8F681B202AEC4617A"
+     "D3DF1ED5D5FD65612433F51F5F066ED0856365553DED1AF3B557135E7F57C935"
+     "984F0C70E0E68B77E2A689DAF3EFE8721DF158A136ADE73530ACCA4F483A797A"
+     "BC0AB182B324FB61D108A94BB2C8E3FBB96ADAB760D7F4681D4F42A3DE394DF4"
+     "AE56EDE76372BB190B07A7C8EE0A6D709E02FCE1CDF7E2ECC03404CD28342F61"
+     "9172FE9CE98583FF8E4F1232EEF28183C3FE3B1B4C6FAD733BB5FCBC2EC22005"
+     "C58EF1837D1683B2C6F34A26C1B2EFFA886B4238611FCFDCDE355B3B6519035B"
+     "BC34F4DEF99C023861B46FC9D6E6C9077AD91D2691F7F7EE598CB0FAC186D91C"
+     "AEFE130985139270B4130C93BC437944F4FD4452E2D74DD364F2E21E71F54BFF"
+     "5CAE82AB9C9DF69EE86D2BC522363A0DABC521979B0DEADA1DBF9A42D5C4484E"
+     "0ABCD06BFA53DDEF3C1B20EE3FD59D7C25E41D2B66C62E37FFFFFFFFFFFFFFFF"},
+    {"ffdhe4096",
+     "FFFFFFFFFFFFFFFFADF85458A2BB4A9AAFDC5620273D3CF1D8B9C583CE2D3695"
+     "A9E13641146433FBCC939DCE249B3EF97D2FE363630C75D8F681B202AEC4617A"
+     "D3DF1ED5D5FD65612433F51F5F066ED0856365553DED1AF3B557135E7F57C935"
+     "984F0C70E0E68B77E2A689DAF3EFE8721DF158A136ADE73530ACCA4F483A797A"
+     "BC0AB182B324FB61D108A94BB2C8E3FBB96ADAB760D7F4681D4F42A3DE394DF4"
+     "AE56EDE76372BB190B07A7C8EE0A6D709E02FCE1CDF7E2ECC03404CD28342F61"
+     "9172FE9CE98583FF8E4F1232EEF28183C3FE3B1B4C6FAD733BB5FCBC2EC22005"
+     "C58EF1837D1683B2C6F34A26C1B2EFFA886B4238611FCFDCDE355B3B6519035B"
+     "BC34F4DEF99C023861B46FC9D6E6C9077AD91D2691F7F7EE598CB0FAC186D91C"
+     "AEFE130985139270B4130C93BC437944F4FD4452E2D74DD364F2E21E71F54BFF"
+     "5CAE82AB9C9DF69EE86D2BC522363A0DABC521979B0DEADA1DBF9A42D5C4484E"
+     "0ABCD06BFA53DDEF3C1B20EE3FD59D7C25E41D2B669E1EF16E6F52C3164DF4FB"
+     "7930E9E4E58857B6AC7D5F42D69F6D187763CF1D5503400487F55BA57E31CC7A"
+     "7135C886EFB4318AED6A1E012D9E6832A907600A918130C46DC778F971AD0038"
+     "092999A333CB8B7A1A1DB93D7140003C2A4ECEA9F98D0ACC0A8291CDCEC97DCF"
+     "8EC9B55A7F88A46B4DB5A851F44182E1C68A007E5E655F6AFFFFFFFFFFFFFFFF"},
+};
+
+static BigInt from_hex(const char *hex)
+{
+    size_t len = strlen(hex);
+    BigInt r;
+    r.data.assign((len + 7) / 8, 0u);
+    for (size_t i = 0; i < len; ++i)
+    {
+        char c = hex[len - 1 - i];
+        uint32_t v = (c >= '0' && c <= '9') ? uint32_t(c - '0') : uint32_t((c | 0x20) - 'a' + 10);
+        r.data[i / 8] |= v << (4 * (i % 8));
+    }
+    r.normalize();
+    return r;
+}
+
+vector<string> builtin_dh_group_names()
+{
+    vector<string> names;
+    for (const auto &g : BUILTIN_GROUPS)
+        names.push_back(g.name);
+    return names;
+}
+
+bool builtin_dh_group(const string &name, DHGroup &out, int table_exp_bits, int table_window)
+{
+    for (const auto &g : BUILTIN_GROUPS)
+    {
+        if (name == g.name)
+        {
+            out = make_dh_group(g.name, from_hex(g.hex), BigInt(2), table_exp_bits, table_window);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ===== DHGroup =====
+
+BigInt default_generator(const BigInt &p)
+{
+    return (p.data[0] & 7u) == 7u ? BigInt(2) : BigInt(4);
+}
+
+DHGroup make_dh_group(const string &name, const BigInt &p, const BigInt &g, int table_exp_bits, int table_window)
+{
+    if (name.size() >= sizeof(GroupRecordHeader::name))
+        throw runtime_error("make_dh_group: name too long");
+    DHGroup group;
+    group.name = name;
+    group.p = p;
+    group.p.normalize();
+    group.bits = int(group.p.bit_length());
+    group.q = group.p - 1u;
+    group.q.shr_bits_inplace(1);
+    group.g = g;
+    group.mont = MontgomeryContext(group.p);
+    if (table_exp_bits < 0)
+        table_exp_bits = group.bits;
+    if (table_exp_bits > 0)
+    {
+        FixedBaseTable t = build_fixed_base_table(group.mont, group.g, table_exp_bits, table_window);
+        auto owned = make_shared<vector<uint32_t>>(std::move(t.limbs));
+        group.table_window = t.window;
+        group.table_exp_bits = t.exp_bits;
+        group.table_entries = owned->size() / group.mont.words();
+        group.table = shared_ptr<const uint32_t>(owned, owned->data());
+    }
+    return group;
+}
+
+BigInt DHGroup::pow_g(BigIntView exp) const
+{
+    return fixed_base_pow(mont, table.get(), table_window, table_exp_bits, g, exp);
+}
+
+BigInt DHGroup::pow(BigIntView base, BigIntView exp) const
+{
+    return mont.pow(base, exp);
+}
+
+// ===== Record =====
+
+enum RecordScan
+{
+    RECORD_VALID,   // dùng được
+    RECORD_SKIP,    // khung đúng (biết độ dài) nhưng nội dung không dùng được: bỏ qua, đọc tiếp
+    RECORD_TORN,    // chạy quá cuối file: record ghi dở ở đuôi
+    RECORD_CORRUPT, // khung sai: không biết record kế tiếp bắt đầu ở đâu
+};
+
+static const uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+static const uint64_t FNV_PRIME = 0x100000001b3ull;
+
+// FNV-1a theo từng word 32 bit (không theo byte): bảng 3 MB chỉ tốn cỡ một mili giây
+static uint64_t checksum_words(uint64_t h, const uint32_t *w, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        h = (h ^ w[i]) * FNV_PRIME;
+    return h;
+}
+
+// Checksum của record: header với trường checksum = 0, rồi p, q, g, R^2 và bảng
+static uint64_t record_checksum(const GroupRecordHeader &rh, const uint32_t *numbers, const uint32_t *table)
+{
+    GroupRecordHeader h = rh;
+    h.checksum_lo = h.checksum_hi = 0;
+    uint32_t hw[sizeof(h) / sizeof(uint32_t)];
+    memcpy(hw, &h, sizeof(h));
+    uint64_t sum = checksum_words(FNV_OFFSET, hw, sizeof(hw) / sizeof(uint32_t));
+    sum = checksum_words(sum, numbers, 4 * size_t(rh.words));
+    return checksum_words(sum, table, size_t(rh.table_entries) * rh.words);
+}
+
+// Hằng số tính được từ p phải khớp: p[0] * n0inv = -1 mod 2^32 (kéo theo p lẻ),
+// q = (p - 1) / 2 = p >> 1 và R^2 mod p < p
+static bool record_constants_ok(const GroupRecordHeader *rh)
+{
+    const uint32_t *w = reinterpret_cast<const uint32_t *>(rh + 1);
+    const uint32_t *p = w, *q = w + rh->words, *r2 = w + 3 * rh->words;
+    if (uint32_t(p[0] * rh->n0inv) != 0xFFFFFFFFu)
+        return false;
+    for (size_t i = 0; i < rh->words; ++i)
+    {
+        uint32_t hi = i + 1 < rh->words ? p[i + 1] : 0u;
+        if (q[i] != ((p[i] >> 1) | (hi << 31)))
+            return false;
+    }
+    return compare(BigIntView(r2, rh->words), BigIntView(p, rh->words)) < 0;
+}
+
+// Phân loại record bắt đầu ở base + off; bytes = độ dài record khi VALID hoặc SKIP
+static RecordScan scan_record(const char *base, size_t len, size_t off, size_t &bytes)
+{
+    if (off + sizeof(GroupRecordHeader) > len)
+        return RECORD_TORN;
+    const GroupRecordHeader *rh = reinterpret_cast<const GroupRecordHeader *>(base + off);
+    uint64_t cells = (4ull + rh->table_entries) * rh->words; // số word sau header
+    if (rh->magic != RECORD_MAGIC || rh->words == 0 || cells > 0xFFFFFFFFull / sizeof(uint32_t) ||
+        rh->record_bytes != sizeof(GroupRecordHeader) + cells * sizeof(uint32_t))
+        return RECORD_CORRUPT;
+    if (off + rh->record_bytes > len)
+        return RECORD_TORN;
+    bytes = rh->record_bytes;
+    // bảng phải có đúng số entry mà fixed_base_pow sẽ đọc với (window, exp_bits) này
+    if (rh->table_entries)
+    {
+        if (rh->table_window < 1 || rh->table_window > 8 || rh->table_exp_bits == 0)
+            return RECORD_SKIP;
+        uint64_t rows = (uint64_t(rh->table_exp_bits) + rh->table_window - 1) / rh->table_window;
+        if (rows * ((1ull << rh->table_window) - 1) != rh->table_entries)
+            return RECORD_SKIP;
+    }
+    const uint32_t *payload = reinterpret_cast<const uint32_t *>(rh + 1);
+    uint64_t sum = record_checksum(*rh, payload, payload + 4 * size_t(rh->words));
+    if (rh->checksum_lo != uint32_t(sum) || rh->checksum_hi != uint32_t(sum >> 32) || !record_constants_ok(rh))
+        return RECORD_SKIP;
+    return RECORD_VALID;
+}
+
+// Kiểm tra header file rồi liệt kê offset các record hợp lệ. Trả về byte ngay sau record
+// cuối cùng đọc được khung (kể cả record bị bỏ qua); torn_tail = true khi phần còn lại sau
+// đó chỉ là một record ghi dở, tức là cắt đi an toàn. `what` chỉ dùng trong thông báo lỗi.
+static size_t scan_records(const char *base, size_t len, const string &what, vector<size_t> &records,
+                           bool &torn_tail)
+{
+    GroupFileHeader fh;
+    if (len < sizeof(fh))
+        throw runtime_error("DHGroupStore: " + what + " is truncated");
+    memcpy(&fh, base, sizeof(fh));
+    if (memcmp(fh.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+        throw runtime_error("DHGroupStore: " + what + " is not a group store");
+    if (fh.version != FILE_VERSION || fh.header_bytes < sizeof(fh) || fh.header_bytes % sizeof(uint32_t) != 0)
+        throw runtime_error("DHGroupStore: unsupported version in " + what);
+
+    size_t off = fh.header_bytes, bytes = 0;
+    torn_tail = false;
+    while (off < len)
+    {
+        RecordScan r = scan_record(base, len, off, bytes);
+        if (r == RECORD_TORN)
+            torn_tail = true;
+        if (r == RECORD_TORN || r == RECORD_CORRUPT)
+            break;
+        if (r == RECORD_VALID)
+            records.push_back(off);
+        off += bytes;
+    }
+    return off;
+}
+
+static const GroupRecordHeader *record_at(const char *base, size_t off)
+{
+    return reinterpret_cast<const GroupRecordHeader *>(base + off);
+}
+
+static string record_name(const GroupRecordHeader *rh)
+{
+    return string(rh->name, strnlen(rh->name, sizeof(rh->name)));
+}
+
+// Số thứ k trong record (0: p, 1: q, 2: g, 3: R^2 mod p)
+static BigIntView record_number(const GroupRecordHeader *rh, size_t k)
+{
+    const uint32_t *w = reinterpret_cast<const uint32_t *>(rh + 1);
+    return BigIntView(w + k * rh->words, rh->words);
+}
+
+// Dựng DHGroup từ record; bảng trỏ thẳng vào vùng nhớ do `owner` giữ
+static DHGroup load_record(const shared_ptr<const void> &owner, const GroupRecordHeader *rh)
+{
+    DHGroup g;
+    g.name = record_name(rh);
+    g.bits = int(rh->bits);
+    g.p = BigInt(record_number(rh, 0));
+    g.q = BigInt(record_number(rh, 1));
+    g.g = BigInt(record_number(rh, 2));
+    g.mont = MontgomeryContext(g.p, rh->n0inv, BigInt(record_number(rh, 3)));
+    g.table_window = int(rh->table_window);
+    g.table_exp_bits = int(rh->table_exp_bits);
+    g.table_entries = rh->table_entries;
+    if (rh->table_entries)
+        g.table = shared_ptr<const uint32_t>(owner, reinterpret_cast<const uint32_t *>(rh + 1) + 4 * rh->words);
+    return g;
+}
+
+static GroupRecordHeader make_record_header(const DHGroup &group, const char *who)
+{
+    const size_t n = group.mont.words();
+    if (n == 0)
+        throw runtime_error(string(who) + ": group has no Montgomery context");
+    if (group.name.size() >= sizeof(GroupRecordHeader::name))
+        throw runtime_error(string(who) + ": name too long");
+    uint64_t record_bytes = sizeof(GroupRecordHeader) + (4ull + group.table_entries) * n * sizeof(uint32_t);
+    if (record_bytes > 0xFFFFFFFFull)
+        throw runtime_error(string(who) + ": record too large");
+
+    GroupRecordHeader rh;
+    memset(&rh, 0, sizeof(rh));
+    rh.magic = RECORD_MAGIC;
+    rh.record_bytes = uint32_t(record_bytes);
+    rh.bits = uint32_t(group.bits);
+    rh.words = uint32_t(n);
+    rh.n0inv = group.mont.n0inv();
+    rh.table_window = uint32_t(group.table_window);
+    rh.table_exp_bits = uint32_t(group.table_exp_bits);
+    rh.table_entries = uint32_t(group.table_entries);
+    memcpy(rh.name, group.name.data(), group.name.size());
+    return rh;
+}
+
+static void set_record_checksum(GroupRecordHeader &rh, const vector<uint32_t> &numbers, const DHGroup &group)
+{
+    uint64_t sum = record_checksum(rh, numbers.data(), group.table.get());
+    rh.checksum_lo = uint32_t(sum);
+    rh.checksum_hi = uint32_t(sum >> 32);
+}
+
+// p, q, g, R^2 mod p, mỗi số đúng words() word
+static vector<uint32_t> record_numbers(const DHGroup &group)
+{
+    const size_t n = group.mont.words();
+    vector<uint32_t> numbers(4 * n, 0u);
+    group.mont.load_words(numbers.data(), group.p);
+    group.mont.load_words(numbers.data() + n, group.q);
+    group.mont.load_words(numbers.data() + 2 * n, group.g);
+    group.mont.load_words(numbers.data() + 3 * n, group.mont.r2());
+    return numbers;
+}
+
+static GroupFileHeader make_file_header()
+{
+    GroupFileHeader fh;
+    memcpy(fh.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    fh.version = FILE_VERSION;
+    fh.header_bytes = sizeof(GroupFileHeader);
+    return fh;
+}
+
+vector<uint8_t> serialize_dh_group(const DHGroup &group)
+{
+    GroupFileHeader fh = make_file_header();
+    GroupRecordHeader rh = make_record_header(group, "serialize_dh_group");
+    vector<uint32_t> numbers = record_numbers(group);
+    set_record_checksum(rh, numbers, group);
+    size_t table_bytes = group.table_bytes();
+
+    vector<uint8_t> out(sizeof(fh) + rh.record_bytes);
+    uint8_t *w = out.data();
+    memcpy(w, &fh, sizeof(fh));
+    w += sizeof(fh);
+    memcpy(w, &rh, sizeof(rh));
+    w += sizeof(rh);
+    memcpy(w, numbers.data(), numbers.size() * sizeof(uint32_t));
+    w += numbers.size() * sizeof(uint32_t);
+    if (table_bytes)
+        memcpy(w, group.table.get(), table_bytes);
+    return out;
+}
+
+DHGroup load_dh_group_blob(shared_ptr<const void> owner, const uint8_t *data, size_t len, const BigInt &p,
+                           const BigInt &g)
+{
+    if (reinterpret_cast<uintptr_t>(data) % alignof(uint32_t) != 0)
+        throw runtime_error("load_dh_group_blob: blob must be 4-byte aligned");
+    const char *base = reinterpret_cast<const char *>(data);
+    vector<size_t> records;
+    bool torn = false;
+    scan_records(base, len, "blob", records, torn);
+    for (size_t off : records)
+    {
+        const GroupRecordHeader *rh = record_at(base, off);
+        if (compare(record_number(rh, 0), p) == 0 && compare(record_number(rh, 2), g) == 0)
+            return load_record(owner, rh);
+    }
+    throw runtime_error("load_dh_group_blob: no context for this modulus and generator");
+}
+
+// ===== DHGroupStore =====
+
+struct DHGroupStore::Mapping
+{
+    void *addr = nullptr;
+    size_t len = 0;
+    ~Mapping()
+    {
+        if (addr)
+            munmap(addr, len);
+    }
+};
+
+DHGroupStore::DHGroupStore(const string &path) : path_(path)
+{
+    reload();
+}
+
+void DHGroupStore::reload()
+{
+    map_.reset();
+    records_.clear();
+    valid_end_ = 0;
+    torn_tail_ = false;
+
+    int fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+            return;
+        throw runtime_error("DHGroupStore: cannot open " + path_ + ": " + strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw runtime_error("DHGroupStore: cannot stat " + path_);
+    }
+    size_t len = size_t(st.st_size);
+    if (len == 0)
+    {
+        ::close(fd);
+        return;
+    }
+    void *addr = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        throw runtime_error("DHGroupStore: mmap failed for " + path_);
+    map_ = make_shared<Mapping>();
+    map_->addr = addr;
+    map_->len = len;
+
+    valid_end_ = scan_records(static_cast<const char *>(addr), len, path_, records_, torn_tail_);
+}
+
+DHGroup DHGroupStore::load(size_t index) const
+{
+    return load_record(map_, record_at(static_cast<const char *>(map_->addr), records_[index]));
+}
+
+vector<DHGroupStore::Info> DHGroupStore::list() const
+{
+    vector<Info> out;
+    const char *base = records_.empty() ? nullptr : static_cast<const char *>(map_->addr);
+    for (size_t off : records_)
+    {
+        const GroupRecordHeader *rh = record_at(base, off);
+        out.push_back({record_name(rh), int(rh->bits), int(rh->table_window), int(rh->table_exp_bits),
+                       size_t(rh->table_entries) * rh->words * sizeof(uint32_t),
+                       size_t(4) * rh->words * sizeof(uint32_t)});
+    }
+    return out;
+}
+
+bool DHGroupStore::find(int bits, DHGroup &out) const
+{
+    const char *base = records_.empty() ? nullptr : static_cast<const char *>(map_->addr);
+    for (size_t i = 0; i < records_.size(); ++i)
+    {
+        if (int(record_at(base, records_[i])->bits) == bits)
+        {
+            out = load(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DHGroupStore::find(const string &name, DHGroup &out) const
+{
+    const char *base = records_.empty() ? nullptr : static_cast<const char *>(map_->addr);
+    for (size_t i = 0; i < records_.size(); ++i)
+    {
+        if (name == record_name(record_at(base, records_[i])))
+        {
+            out = load(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DHGroupStore::find(const BigInt &p, const BigInt &g, DHGroup &out) const
+{
+    const char *base = records_.empty() ? nullptr : static_cast<const char *>(map_->addr);
+    for (size_t i = 0; i < records_.size(); ++i)
+    {
+        const GroupRecordHeader *rh = record_at(base, records_[i]);
+        if (compare(record_number(rh, 0), p) == 0 && compare(record_number(rh, 2), g) == 0)
+        {
+            out = load(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void write_all(int fd, const void *buf, size_t len, const string &path)
+{
+    const char *p = static_cast<const char *>(buf);
+    while (len > 0)
+    {
+        ssize_t k = ::write(fd, p, len);
+        if (k < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw runtime_error("DHGroupStore: write failed for " + path + ": " + strerror(errno));
+        }
+        p += k;
+        len -= size_t(k);
+    }
+}
+
+void DHGroupStore::append(const DHGroup &group)
+{
+    const size_t n = group.mont.words();
+    GroupRecordHeader rh = make_record_header(group, "DHGroupStore::append");
+    vector<uint32_t> numbers = record_numbers(group);
+    set_record_checksum(rh, numbers, group);
+
+    int fd = ::open(path_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        throw runtime_error("DHGroupStore: cannot open " + path_ + " for writing: " + strerror(errno));
+    // khóa độc quyền để hai tiến trình không ghi xen nhau
+    if (flock(fd, LOCK_EX) != 0)
+    {
+        int err = errno;
+        ::close(fd);
+        throw runtime_error("DHGroupStore: cannot lock " + path_ + ": " + strerror(err));
+    }
+    try
+    {
+        reload(); // tiến trình khác có thể đã append trước khi ta có khóa
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+            throw runtime_error("DHGroupStore: cannot stat " + path_ + ": " + strerror(errno));
+        if (st.st_size == 0)
+        {
+            GroupFileHeader fh = make_file_header();
+            write_all(fd, &fh, sizeof(fh), path_);
+            valid_end_ = sizeof(fh);
+        }
+        else if (size_t(st.st_size) > valid_end_)
+        {
+            // Chỉ cắt khi phần thừa là một record ghi dở ở đuôi. Dữ liệu không đọc được ở giữa
+            // có thể còn record hợp lệ phía sau nên không được ghi đè.
+            if (!torn_tail_)
+                throw runtime_error("DHGroupStore::append: unreadable data at byte " + to_string(valid_end_) +
+                                    " of " + path_ + ", refusing to overwrite it");
+            if (ftruncate(fd, off_t(valid_end_)) != 0)
+                throw runtime_error("DHGroupStore: cannot truncate " + path_ + ": " + strerror(errno));
+        }
+        if (lseek(fd, off_t(valid_end_), SEEK_SET) == off_t(-1))
+            throw runtime_error("DHGroupStore: cannot seek in " + path_ + ": " + strerror(errno));
+        write_all(fd, &rh, sizeof(rh), path_);
+        write_all(fd, numbers.data(), numbers.size() * sizeof(uint32_t), path_);
+        if (group.table_entries)
+            write_all(fd, group.table.get(), group.table_entries * n * sizeof(uint32_t), path_);
+    }
+    catch (...)
+    {
+        flock(fd, LOCK_UN);
+        ::close(fd);
+        throw;
+    }
+    flock(fd, LOCK_UN);
+    ::close(fd);
+    reload();
+}
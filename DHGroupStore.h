@@ -0,0 +1,117 @@
+// DHGroupStore.h
+// Nhóm Diffie-Hellman dựng sẵn (p, q, g, hằng số Montgomery, bảng lũy thừa cố định của g)
+// và kho lưu bền vững dạng file nhị phân được mmap khi mở.
+//
+// Định dạng file (little-endian, mọi trường 32-bit):
+//   header: magic "DHGROUPS" (8 byte), version, header_bytes
+//   các record nối tiếp nhau, mỗi record:
+//     magic 'DHGR', record_bytes, bits, words, n0inv, table_window, table_exp_bits,
+//     table_entries, name[32], checksum (64 bit: lo, hi)
+//     p, q, g, R^2 mod p            (mỗi số đúng `words` word)
+//     bảng: table_entries entry     (mỗi entry `words` word, dạng Montgomery)
+// checksum là FNV-1a 64 bit theo word trên header (với checksum = 0), các số và bảng.
+// Khi mở file, mỗi record được kiểm tra độ dài, kích thước bảng (số entry phải đúng bằng
+// ceil(table_exp_bits / table_window) * (2^table_window - 1)), checksum và các hằng số suy
+// ra được từ p (p[0] * n0inv = -1 mod 2^32, q = (p - 1) / 2, R^2 mod p < p); các số đọc
+// thẳng từ vùng mmap. Record có khung đúng nhưng nội dung sai bị bỏ qua, các record sau nó
+// vẫn dùng được. Record cuối bị cắt dở (ví dụ tiến trình chết khi đang ghi) bị bỏ qua và bị
+// xóa ở lần append sau; gặp dữ liệu không đọc được khung ở giữa file thì append từ chối ghi.
+// File version 1 (record chưa có checksum) không còn được đọc.
+//
+// serialize_dh_group cho cùng định dạng (header + một record) trong bộ nhớ: blob có thể ghi
+// ra file rồi mở bằng DHGroupStore, hoặc đặt vào vùng nhớ chia sẻ để worker nạp bằng
+// load_dh_group_blob mà không dựng lại hằng số Montgomery hay bảng.
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "BigInt.h"
+#include "Montgomery.h"
+
+struct DHGroup
+{
+    std::string name;
+    int bits = 0;
+    BigInt p, q, g; // p = 2q + 1
+    MontgomeryContext mont;
+
+    // Bảng FixedBaseTable của g (có thể rỗng). `table` trỏ vào bộ nhớ riêng hoặc vào
+    // vùng mmap của DHGroupStore; shared_ptr giữ vùng đó sống khi store đã bị hủy.
+    int table_window = 0;
+    int table_exp_bits = 0;
+    size_t table_entries = 0;
+    std::shared_ptr<const uint32_t> table;
+
+    // g^exp mod p, dùng bảng nếu exp đủ ngắn
+    BigInt pow_g(BigIntView exp) const;
+    // base^exp mod p bằng Montgomery; base có thể là view lên khóa của peer trong buffer nhận
+    BigInt pow(BigIntView base, BigIntView exp) const;
+    size_t table_bytes() const { return table_entries * mont.words() * sizeof(uint32_t); }
+    // p, q, g và R^2 mod p như lưu trong record
+    size_t constants_bytes() const { return 4 * mont.words() * sizeof(uint32_t); }
+};
+
+// Dựng nhóm từ p (số nguyên tố an toàn) và g: tính q, hằng số Montgomery và bảng.
+// table_exp_bits < 0: bảng phủ số mũ dài bit_length(p); 0: không dựng bảng.
+DHGroup make_dh_group(const std::string &name, const BigInt &p, const BigInt &g,
+                      int table_exp_bits = -1, int table_window = 2);
+
+// Phần tử sinh của nhóm con bậc q cho số nguyên tố an toàn p: 2 nếu 2 là thặng dư
+// bậc hai mod p (p = 7 mod 8), ngược lại 4
+BigInt default_generator(const BigInt &p);
+
+// Nhóm MODP dựng sẵn: RFC 3526 "modp1536", "modp2048", "modp3072", "modp4096";
+// RFC 7919 "ffdhe2048", "ffdhe3072", "ffdhe4096". Tất cả dùng g = 2.
+std::vector<std::string> builtin_dh_group_names();
+bool builtin_dh_group(const std::string &name, DHGroup &out, int table_exp_bits = -1, int table_window = 2);
+
+// Blob độc lập của một nhóm (header file + một record, xem định dạng ở trên)
+std::vector<uint8_t> serialize_dh_group(const DHGroup &group);
+// Nạp nhóm có đúng modulus p và phần tử sinh g từ blob [data, data + len). Bảng trỏ thẳng
+// vào blob; `owner` giữ vùng nhớ chứa blob sống cùng nhóm. Ném runtime_error khi blob hỏng,
+// khác version hoặc không có record nào cho (p, g).
+DHGroup load_dh_group_blob(std::shared_ptr<const void> owner, const uint8_t *data, size_t len,
+                           const BigInt &p, const BigInt &g);
+
+class DHGroupStore
+{
+public:
+    struct Info
+    {
+        std::string name;
+        int bits;
+        int table_window;
+        int table_exp_bits;
+        size_t table_bytes;     // bảng lũy thừa cố định của g
+        size_t constants_bytes; // p, q, g, R^2 mod p
+    };
+
+    // Mở (mmap) file nếu đã tồn tại; file chưa có được coi là kho rỗng
+    explicit DHGroupStore(const std::string &path);
+
+    const std::string &path() const { return path_; }
+    size_t size() const { return records_.size(); }
+    std::vector<Info> list() const;
+
+    // Record đầu tiên có đúng số bit / tên; false nếu không có
+    bool find(int bits, DHGroup &out) const;
+    bool find(const std::string &name, DHGroup &out) const;
+    // Record của đúng nhóm (p, g): so thẳng các word trong vùng mmap, không sao chép
+    bool find(const BigInt &p, const BigInt &g, DHGroup &out) const;
+
+    // Ghi thêm nhóm vào cuối file (tạo file nếu chưa có) rồi map lại
+    void append(const DHGroup &group);
+    // Map lại file (ví dụ khi tiến trình khác vừa append)
+    void reload();
+
+private:
+    struct Mapping;
+    DHGroup load(size_t index) const;
+
+    std::string path_;
+    std::shared_ptr<Mapping> map_;
+    std::vector<size_t> records_; // offset (byte) của từng record hợp lệ
+    size_t valid_end_ = 0;        // byte ngay sau record cuối cùng đọc được khung
+    bool torn_tail_ = false;      // phần sau valid_end_ chỉ là record ghi dở (cắt được)
+};
@@ -0,0 +1,345 @@
+// DHGroupStore_test.cpp
+// Tests for Montgomery arithmetic, fixed-base tables and the mmap-backed group store
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <unistd.h>
+#include "BigInt.h"
+#include "DiffieHellman.h"
+#include "Montgomery.h"
+#include "DHGroupStore.h"
+#include "DHValidate.h"
+#include "ChaCha20.h"
+
+using namespace std;
+
+static void expect_true(bool cond, const char *msg)
+{
+    if (!cond)
+    {
+        cerr << "FAIL: " << msg << "\n";
+        exit(1);
+    }
+    else
+        cout << "ok: " << msg << "\n";
+}
+
+static BigInt random_below(const BigInt &n, ChaCha20Rng &rng)
+{
+    BigInt r;
+    r.data.assign(n.data.size() + 1, 0u);
+    rng.fill(r.data.data(), r.data.size());
+    r.normalize();
+    return r % n;
+}
+
+int main()
+{
+    const uint32_t seed_key[8] = {9, 8, 7, 6, 5, 4, 3, 2};
+    ChaCha20Rng rng(seed_key, 7);
+
+    // 1) Montgomery pow agrees with modular_exponentiation (odd moduli, several sizes)
+    {
+        bool ok = true;
+        const int sizes[] = {1, 2, 3, 8, 17};
+        for (int words : sizes)
+        {
+            BigInt n;
+            n.data.assign(words, 0u);
+            rng.fill(n.data.data(), n.data.size());
+            n.data[0] |= 1u;
+            n.data[words - 1] |= 0x80000000u;
+            if (words == 1)
+                n = BigInt(23);
+            MontgomeryContext ctx(n);
+            for (int i = 0; i < 8; ++i)
+            {
+                BigInt b = random_below(n, rng);
+                BigInt e = random_below(n, rng);
+                ok = ok && ctx.pow(b, e) == modular_exponentiation(b, e, n);
+                ok = ok && ctx.from_mont(ctx.to_mont(b)) == b;
+            }
+            ok = ok && ctx.pow(BigInt(5), BigInt(0)) == BigInt(1);
+        }
+        expect_true(ok, "MontgomeryContext::pow matches modular_exponentiation");
+    }
+
+    // 2) Fixed-base table agrees with plain pow, including exponents longer than the table
+    {
+        BigInt p = generate_safe_prime(96);
+        BigInt g = default_generator(p);
+        MontgomeryContext ctx(p);
+        bool ok = true;
+        for (int window = 1; window <= 5; ++window)
+        {
+            FixedBaseTable t = build_fixed_base_table(ctx, g, 96, window);
+            for (int i = 0; i < 6; ++i)
+            {
+                BigInt e = random_below(p, rng);
+                ok = ok && fixed_base_pow(ctx, t, g, e) == modular_exponentiation(g, e, p);
+            }
+            BigInt big = p * p;
+            ok = ok && fixed_base_pow(ctx, t, g, big) == modular_exponentiation(g, big, p);
+        }
+        expect_true(ok, "fixed_base_pow matches modular_exponentiation for windows 1..5");
+    }
+
+    // 3) Built-in RFC groups: p = 2q + 1, g = 2, table covers full exponents
+    {
+        vector<string> names = builtin_dh_group_names();
+        expect_true(names.size() == 7, "seven built-in groups");
+        DHGroup g;
+        expect_true(builtin_dh_group("modp1536", g, 0), "modp1536 is built in");
+        expect_true(g.bits == 1536 && g.q + g.q + BigInt(1) == g.p && g.g == BigInt(2), "modp1536 shape");
+        expect_true(builtin_dh_group("ffdhe2048", g, 0) && g.bits == 2048, "ffdhe2048 has 2048 bits");
+        expect_true(!builtin_dh_group("modp1024", g), "unknown name rejected");
+    }
+
+    // 4) Store: append, reopen through mmap, find by bits and name, truncated tail ignored
+    {
+        char path[] = "/tmp/dh_group_test_XXXXXX";
+        int fd = mkstemp(path);
+        close(fd);
+        remove(path);
+
+        BigInt p = generate_safe_prime(80);
+        DHGroup made = make_dh_group("safe80", p, default_generator(p), -1, 3);
+        DHGroup rfc;
+        builtin_dh_group("modp1536", rfc, 256, 4);
+        {
+            DHGroupStore store(path);
+            expect_true(store.size() == 0, "missing file is an empty store");
+            store.append(made);
+            store.append(rfc);
+            expect_true(store.size() == 2, "two groups appended");
+        }
+
+        DHGroup loaded;
+        {
+            DHGroupStore store(path);
+            expect_true(store.size() == 2, "reopened store sees both records");
+            expect_true(store.find(80, loaded), "find by bits");
+            vector<DHGroupStore::Info> info = store.list();
+            expect_true(info[1].name == "modp1536" && info[1].table_bytes == rfc.table_bytes(), "list reports table size");
+        }
+        // store destroyed: the table still points into the live mapping
+        bool same = loaded.p == made.p && loaded.q == made.q && loaded.g == made.g &&
+                    loaded.mont.n0inv() == made.mont.n0inv() && loaded.mont.r2() == made.mont.r2() &&
+                    loaded.table_entries == made.table_entries;
+        expect_true(same, "loaded constants equal the computed ones");
+        BigInt e = random_below(p, rng);
+        expect_true(loaded.pow_g(e) == modular_exponentiation(made.g, e, p), "pow_g from mmap table");
+
+        DHGroupStore store(path);
+        DHGroup modp;
+        expect_true(store.find("modp1536", modp), "find by name");
+        BigInt k = generate_private_key(modp.p, 256, rng);
+        expect_true(modp.pow_g(k) == modp.pow(modp.g, k), "modp1536 table pow equals Montgomery pow");
+
+        // simulate a crash halfway through an append
+        FILE *f = fopen(path, "ab");
+        fwrite("DHGRgarbage", 1, 11, f);
+        fclose(f);
+        store.reload();
+        expect_true(store.size() == 2, "truncated trailing record ignored");
+        DHGroup again = load_or_create_group(store, "80");
+        expect_true(again.p == p, "load_or_create_group reuses cached group");
+        load_or_create_group(store, "ffdhe2048");
+        expect_true(store.size() == 3, "append after truncated tail");
+        remove(path);
+    }
+
+    // 5) Public-value validation: Jacobi fast path agrees with B^q = 1, batch reports each key
+    {
+        BigInt p = generate_safe_prime(64);
+        DHGroup g = make_dh_group("safe64", p, default_generator(p), 0);
+        bool agree = true;
+        int residues = 0;
+        for (int i = 0; i < 200; ++i)
+        {
+            BigInt B = random_below(p, rng);
+            DHKeyCheck fast = check_public_value(g, B);
+            agree = agree && fast == check_public_value_strict(g, B);
+            residues += fast == DH_KEY_OK;
+        }
+        expect_true(agree, "Jacobi check agrees with B^q == 1");
+        expect_true(residues > 60 && residues < 140, "about half of random values are in the subgroup");
+        BigInt pub = g.pow_g(generate_private_key(p, 0, rng));
+        expect_true(check_public_value(g, pub) == DH_KEY_OK, "honest public value accepted");
+        expect_true(check_public_value(g, BigInt(1)) == DH_KEY_OUT_OF_RANGE &&
+                        check_public_value(g, p - BigInt(1)) == DH_KEY_OUT_OF_RANGE &&
+                        check_public_value(g, p) == DH_KEY_OUT_OF_RANGE &&
+                        check_public_value(g, BigInt(0)) == DH_KEY_OUT_OF_RANGE,
+                    "0, 1, p-1 and p rejected");
+        BigInt nonres = BigInt(2);
+        while (check_public_value_strict(g, nonres) == DH_KEY_OK)
+            nonres = nonres + BigInt(1);
+        vector<BigInt> keys = {pub, g.pow_g(BigInt(12345)), nonres, p - BigInt(1)};
+        vector<DHKeyCheck> results;
+        bool all = check_public_values(g, keys, &results);
+        expect_true(!all && results[0] == DH_KEY_OK && results[1] == DH_KEY_OK &&
+                        results[2] == DH_KEY_NOT_IN_SUBGROUP && results[3] == DH_KEY_OUT_OF_RANGE,
+                    "batch validation reports each key");
+        keys.resize(2);
+        expect_true(check_public_values(g, keys), "batch of honest keys accepted");
+    }
+
+    // 6) Derivation reads the peer key in place from a received word buffer
+    {
+        BigInt p = generate_safe_prime(96);
+        DHGroup g = make_dh_group("safe96", p, default_generator(p));
+        BigInt a = generate_private_key(p, 0, rng), b = generate_private_key(p, 0, rng);
+        BigInt B = g.pow_g(b);
+        vector<uint32_t> wire(g.mont.words() + 2, 0u); // số đệm word 0 như trong gói tin
+        copy(B.data.begin(), B.data.end(), wire.begin());
+        BigIntView peer(wire.data(), wire.size());
+        expect_true(check_public_value(g, peer) == DH_KEY_OK, "validate peer view");
+        expect_true(g.pow(peer, a) == g.pow(B, a) && g.pow(peer, a) == g.pow(g.pow_g(a), b),
+                    "shared secret from view matches owned value");
+        expect_true(modular_exponentiation(peer, BigIntView(a), p) == g.pow(B, a), "modexp with view base");
+    }
+
+    // 7) Standalone context blob: tied to (p, g), table read in place, rejects damaged blobs
+    {
+        DHGroup rfc;
+        builtin_dh_group("modp1536", rfc, 256, 4);
+        auto blob = make_shared<vector<uint8_t>>(serialize_dh_group(rfc));
+        expect_true(blob->size() == 16 + 72 + rfc.constants_bytes() + rfc.table_bytes(), "blob size is header + record");
+        DHGroup w = load_dh_group_blob(blob, blob->data(), blob->size(), rfc.p, rfc.g);
+        const uint8_t *tp = reinterpret_cast<const uint8_t *>(w.table.get());
+        expect_true(tp >= blob->data() && tp + w.table_bytes() == blob->data() + blob->size(),
+                    "table points into the blob");
+        expect_true(w.mont.r2() == rfc.mont.r2() && w.mont.n0inv() == rfc.mont.n0inv() && w.q == rfc.q,
+                    "blob constants equal the computed ones");
+        BigInt k = generate_private_key(rfc.p, 256, rng);
+        expect_true(w.pow_g(k) == rfc.pow_g(k), "pow_g from blob table");
+
+        auto rejects = [&](const vector<uint8_t> &b, const BigInt &p, const BigInt &g)
+        {
+            try
+            {
+                load_dh_group_blob(nullptr, b.data(), b.size(), p, g);
+            }
+            catch (const runtime_error &)
+            {
+                return true;
+            }
+            return false;
+        };
+        expect_true(rejects(*blob, rfc.p, BigInt(5)), "blob for another generator rejected");
+        expect_true(rejects(*blob, rfc.p + BigInt(2), rfc.g), "blob for another modulus rejected");
+        vector<uint8_t> bad = *blob;
+        bad[8] = 99; // version
+        expect_true(rejects(bad, rfc.p, rfc.g), "unknown version rejected");
+        bad = *blob;
+        bad.resize(bad.size() - 4);
+        expect_true(rejects(bad, rfc.p, rfc.g), "truncated blob rejected");
+        bad = *blob;
+        bad[16 + 20] = 5; // table_window không khớp số entry
+        expect_true(rejects(bad, rfc.p, rfc.g), "table geometry mismatch rejected");
+        bad = *blob;
+        bad[8] = 1; // file version 1: record chưa có checksum
+        expect_true(rejects(bad, rfc.p, rfc.g), "version 1 file rejected");
+        bad = *blob;
+        bad[bad.size() - 100] ^= 0x01; // một bit trong bảng
+        expect_true(rejects(bad, rfc.p, rfc.g), "flipped table bit rejected by checksum");
+        bad = *blob;
+        bad[16 + 72 + 3 * rfc.constants_bytes() / 4] ^= 0x01; // một bit của R^2 mod p
+        expect_true(rejects(bad, rfc.p, rfc.g), "flipped R^2 bit rejected by checksum");
+
+        // checksum đúng nhưng hằng số không khớp p: vẫn bị từ chối
+        DHGroup wrong = rfc;
+        wrong.mont = MontgomeryContext(rfc.p, rfc.mont.n0inv() + 2u, rfc.mont.r2());
+        bad = serialize_dh_group(wrong);
+        expect_true(rejects(bad, rfc.p, rfc.g), "wrong n0inv rejected");
+        wrong = rfc;
+        wrong.q = rfc.q - BigInt(1);
+        bad = serialize_dh_group(wrong);
+        expect_true(rejects(bad, rfc.p, rfc.g), "q != (p - 1) / 2 rejected");
+        wrong = rfc;
+        wrong.mont = MontgomeryContext(rfc.p, rfc.mont.n0inv(), rfc.p);
+        bad = serialize_dh_group(wrong);
+        expect_true(rejects(bad, rfc.p, rfc.g), "R^2 not below p rejected");
+
+        // blob ghi ra file là một kho hợp lệ
+        char path[] = "/tmp/dh_blob_test_XXXXXX";
+        int fd = mkstemp(path);
+        expect_true(write(fd, blob->data(), blob->size()) == ssize_t(blob->size()), "write blob");
+        close(fd);
+        DHGroupStore store(path);
+        DHGroup found;
+        vector<DHGroupStore::Info> info = store.list();
+        expect_true(store.find(rfc.p, rfc.g, found) && found.pow_g(k) == rfc.pow_g(k) && !store.find(rfc.p, BigInt(5), found),
+                    "find by (p, g) in a store written from a blob");
+        expect_true(info.size() == 1 && info[0].constants_bytes == rfc.constants_bytes() &&
+                        info[0].table_bytes == rfc.table_bytes(),
+                    "list reports constants and table footprint");
+        remove(path);
+    }
+
+    // 8) Append never drops valid records behind a bad one
+    {
+        BigInt p = generate_safe_prime(64);
+        DHGroup a = make_dh_group("safe64", p, default_generator(p), -1, 2), b;
+        builtin_dh_group("modp1536", b, 128, 3);
+        DHGroup c;
+        builtin_dh_group("ffdhe2048", c, 0);
+        vector<uint8_t> ba = serialize_dh_group(a), bb = serialize_dh_group(b);
+        vector<uint8_t> bad = serialize_dh_group(b);
+        bad[16 + 20] = 5; // table_window sai: khung đúng, nội dung không dùng được
+
+        auto write_file = [](const char *path, const vector<uint8_t> &bytes)
+        {
+            FILE *f = fopen(path, "wb");
+            fwrite(bytes.data(), 1, bytes.size(), f);
+            fclose(f);
+        };
+        auto file_size = [](const char *path)
+        {
+            FILE *f = fopen(path, "rb");
+            fseek(f, 0, SEEK_END);
+            long n = ftell(f);
+            fclose(f);
+            return n;
+        };
+        char path[] = "/tmp/dh_append_test_XXXXXX";
+        close(mkstemp(path));
+
+        // header + A + record hỏng nội dung + B
+        vector<uint8_t> file = ba;
+        file.insert(file.end(), bad.begin() + 16, bad.end());
+        file.insert(file.end(), bb.begin() + 16, bb.end());
+        write_file(path, file);
+        DHGroupStore store(path);
+        DHGroup found;
+        expect_true(store.size() == 2 && store.find("modp1536", found), "record after a skipped one is still found");
+        store.append(c);
+        expect_true(store.size() == 3 && store.find("safe64", found) && store.find("modp1536", found) &&
+                        store.find("ffdhe2048", found),
+                    "append keeps records on both sides of a skipped record");
+
+        // khung hỏng ở giữa (magic sai): không biết ranh giới record nên không được ghi đè
+        file = ba;
+        file.insert(file.end(), bad.begin() + 16, bad.end());
+        file[ba.size()] ^= 0xFF; // magic của record thứ hai
+        file.insert(file.end(), bb.begin() + 16, bb.end());
+        write_file(path, file);
+        store.reload();
+        bool threw = false;
+        try
+        {
+            store.append(c);
+        }
+        catch (const runtime_error &)
+        {
+            threw = true;
+        }
+        expect_true(threw && file_size(path) == long(file.size()), "append refuses to overwrite unreadable data");
+        remove(path);
+    }
+
+    cout << "All DH group store tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,68 @@
+// DHValidate.cpp
+#include "DHValidate.h"
+#include "NumberTheory.h"
+#include "BigIntExpr.h"
+
+using namespace std;
+
+const char *dh_key_check_name(DHKeyCheck r)
+{
+    switch (r)
+    {
+    case DH_KEY_OK:
+        return "ok";
+    case DH_KEY_OUT_OF_RANGE:
+        return "out of range";
+    case DH_KEY_NOT_IN_SUBGROUP:
+        return "not in prime-order subgroup";
+    }
+    return "unknown";
+}
+
+static bool in_range(const DHGroup &group, BigIntView B)
+{
+    // 1 < B < p - 1, tức là 2 <= B <= p - 2; so sánh trực tiếp, không tạo B + 1
+    if (B.len == 0 || (B.len == 1 && B.limbs[0] == 1u) || compare(B, group.p) >= 0)
+        return false;
+    // p lẻ nên p - 1 chỉ khác p ở bit thấp nhất
+    BigIntView p = group.p;
+    if (B.len != p.len || B.limbs[0] != (p.limbs[0] & ~1u))
+        return true;
+    for (size_t i = 1; i < B.len; ++i)
+        if (B.limbs[i] != p.limbs[i])
+            return true;
+    return false;
+}
+
+DHKeyCheck check_public_value(const DHGroup &group, BigIntView B)
+{
+    if (!in_range(group, B))
+        return DH_KEY_OUT_OF_RANGE;
+    return jacobi(B, group.p) == 1 ? DH_KEY_OK : DH_KEY_NOT_IN_SUBGROUP;
+}
+
+DHKeyCheck check_public_value_strict(const DHGroup &group, BigIntView B)
+{
+    if (!in_range(group, B))
+        return DH_KEY_OUT_OF_RANGE;
+    return group.pow(B, group.q) == 1u ? DH_KEY_OK : DH_KEY_NOT_IN_SUBGROUP;
+}
+
+bool check_public_values(const DHGroup &group, const vector<BigInt> &keys, vector<DHKeyCheck> *results)
+{
+    if (results)
+        results->assign(keys.size(), DH_KEY_OK);
+    bool all_ok = true;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        DHKeyCheck r = check_public_value(group, keys[i]);
+        if (r != DH_KEY_OK)
+        {
+            all_ok = false;
+            if (!results)
+                return false; // không cần chi tiết: dừng ở khóa hỏng đầu tiên
+            (*results)[i] = r;
+        }
+    }
+    return all_ok;
+}
@@ -0,0 +1,35 @@
+// DHValidate.h
+// Kiểm tra giá trị công khai nhận từ phía bên kia trong nhóm số nguyên tố an toàn p = 2q + 1.
+//
+// Nhóm con bậc q của Z_p^* chính là tập các thặng dư bậc hai, nên với p nguyên tố
+//   B^q = 1 (mod p)  <=>  ký hiệu Legendre (B/p) = 1.
+// Ký hiệu Legendre tính bằng jacobi() (GCD nhị phân, O(n^2) phép word) thay vì một phép
+// lũy thừa đầy đủ O(n^2 log p), cho cùng kết quả một cách chính xác, không xác suất.
+//
+// Vì sao không gộp nhiều khóa vào một phép lũy thừa ngẫu nhiên (prod B_i^r_i)^q: cofactor
+// của nhóm con là 2, nên khóa hỏng có thành phần ±1 và lọt qua phép kiểm gộp với xác suất
+// 1/2 mỗi vòng; đạt độ tin cậy 2^-k cần k phép lũy thừa, đắt hơn nhiều so với kiểm Jacobi
+// từng khóa. Do đó bản batch dưới đây kiểm Jacobi từng khóa và vẫn chính xác.
+#pragma once
+#include <vector>
+#include "BigInt.h"
+#include "DHGroupStore.h"
+
+enum DHKeyCheck
+{
+    DH_KEY_OK = 0,
+    DH_KEY_OUT_OF_RANGE,     // B <= 1 hoặc B >= p - 1
+    DH_KEY_NOT_IN_SUBGROUP,  // B không thuộc nhóm con bậc q
+};
+
+const char *dh_key_check_name(DHKeyCheck r);
+
+// 1 < B < p - 1 và (B/p) = 1. B có thể là view đọc thẳng từ buffer nhận.
+DHKeyCheck check_public_value(const DHGroup &group, BigIntView B);
+// 1 < B < p - 1 và B^q = 1 (mod p) bằng lũy thừa Montgomery; dùng khi không tin p nguyên tố
+DHKeyCheck check_public_value_strict(const DHGroup &group, BigIntView B);
+
+// Kiểm tra nhiều khóa; true nếu tất cả hợp lệ. results (nếu khác nullptr) nhận kết quả
+// từng khóa theo đúng thứ tự.
+bool check_public_values(const DHGroup &group, const std::vector<BigInt> &keys,
+                         std::vector<DHKeyCheck> *results = nullptr);
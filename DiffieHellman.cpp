@@ -1,6 +1,21 @@
 #include <iostream>
 #include <random>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <stdexcept>
+#include <cstdlib>
 #include "BigInt.h"
+#include "BigIntExpr.h"
+#include "BigIntStats.h"
+#include "DiffieHellman.h"
+#include "ThreadPool.h"
+#include "ChaCha20.h"
+#include "RemainderTree.h"
+#include "DHGroupStore.h"
+#include "DHValidate.h"
+#include "LoadGen.h"
 using namespace std;
 
 // parity helper (was previously a method on BigInt; moved here per request)
@@ -9,99 +24,191 @@ static inline bool is_even(const BigInt &n)
     return (n.data.empty() ? true : ((n.data[0] & 1u) == 0));
 }
 
-// A: Triển khai hàm lũy thừa mô-đun
-// Hàm thực hiện: (base^exponent) % mod
-BigInt modular_exponentiation(const BigInt &base, const BigInt &exponent, const BigInt &mod)
+// Lõi của modular_exponentiation. Nếu cancel khác nullptr, kiểm tra cờ sau mỗi bit
+// của số mũ và trả về false ngay khi cờ được bật (result khi đó không có nghĩa).
+// Mọi phép nhân ghi thẳng vào result/base_mod qua ctx nên buffer ổn định suốt vòng lặp.
+static bool modexp_cancellable(BigIntView base, BigIntView exponent, ModContext &ctx,
+                               const atomic<bool> *cancel, BigInt &result)
 {
-    BigInt result(1);
-    BigInt base_mod = base % mod;
+    const BigInt &mod = ctx.modulus();
+    // 1 % mod để x^0 mod 1 = 0
+    result = BigInt(1) % mod;
+    BigInt base_mod;
+    if (compare(base, mod) < 0)
+        base_mod = BigInt(base);
+    else
+    {
+        BigInt q;
+        divmod(base, mod, q, base_mod);
+    }
 
-    BigInt exp = exponent;
-    // Iterate bits of exponent from least-significant to most; use shr_bits(1)
-    while (!(exp == BigInt(0)))
+    // Duyệt bit của số mũ từ thấp lên cao, đọc thẳng từ view (không sao chép số mũ)
+    size_t nbits = exponent.bit_length();
+    for (size_t i = 0; i < nbits; ++i)
     {
-        if ((exp.data.size() > 0) && ((exp.data[0] & 1u) != 0))
-        {
-            result = (result * base_mod) % mod;
-        }
-        base_mod = (base_mod * base_mod) % mod;
-        exp = exp.shr_bits(1);
+        if (cancel && cancel->load(memory_order_relaxed))
+            return false;
+        if (exponent.test_bit(i))
+            mulmod_into(result, result, base_mod, ctx);
+        if (i + 1 < nbits)
+            sqrmod_into(base_mod, base_mod, ctx);
     }
+    return true;
+}
+
+// A: Triển khai hàm lũy thừa mô-đun
+// Hàm thực hiện: (base^exponent) % mod
+BigInt modular_exponentiation(BigIntView base, BigIntView exponent, const BigInt &mod)
+{
+    ModContext ctx(mod);
+    BigInt result;
+    modexp_cancellable(base, exponent, ctx, nullptr, result);
     return result;
 }
 
-bool millerRabinTest(const BigInt &n, const BigInt &a)
+enum MRResult
 {
-    if (a >= BigInt(n - BigInt(1))) return true;
-    BigInt d = n - BigInt(1);
-    BigInt s(0);
-    // factor n-1 = d * 2^s by shifting out low bits
-    while ((d.data.size() > 0) && ((d.data[0] & 1u) == 0))
+    MR_PROBABLE_PRIME,
+    MR_COMPOSITE,
+    MR_CANCELLED
+};
+
+static MRResult miller_rabin_round(const BigInt &n, const BigInt &a, const atomic<bool> *cancel)
+{
+    BIGINT_STAT_ADD(STAT_MR_ROUNDS, 1);
+    const BigInt n_minus_1 = n - 1u;
+    if (a >= n_minus_1) return MR_PROBABLE_PRIME;
+    // n-1 = d * 2^s: một lần ctz và một lần dịch
+    BigInt d = n_minus_1;
+    int s = int(d.count_trailing_zeros());
+    d.shr_bits_inplace(s);
+    ModContext ctx(n);
+    BigInt x;
+    if (!modexp_cancellable(a, d, ctx, cancel, x))
+        return MR_CANCELLED;
+    if (x == 1u || x == n_minus_1)
     {
-        d = d.shr_bits(1);
-        s = s + BigInt(1);
+        return MR_PROBABLE_PRIME;
     }
-    BigInt x = modular_exponentiation(a, d, n);
-    if (x == BigInt(1) || x == n - BigInt(1))
+    for (int r = 1; r < s; ++r)
     {
-        return true;
+        if (cancel && cancel->load(memory_order_relaxed))
+            return MR_CANCELLED;
+        sqrmod_into(x, x, ctx);
+        if (x == n_minus_1)
+            return MR_PROBABLE_PRIME;
+        if (x == 1u)
+            return MR_COMPOSITE;
     }
-    for (BigInt r = BigInt(1); r < s; r = r + BigInt(1))
+    return MR_COMPOSITE;
+}
+
+bool millerRabinTest(const BigInt &n, const BigInt &a)
+{
+    return miller_rabin_round(n, a, nullptr) != MR_COMPOSITE;
+}
+
+// Expanded list of small prime bases for Miller-Rabin (many bases to increase confidence for large sizes)
+static const uint32_t MR_BASES[] = {
+    2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53
+    // 59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131,
+    // 137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+    // 227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311,
+    // 313, 317, 331, 337, 347, 349, 353, 359, 367, 373, 379, 383, 389, 397, 401, 409,
+    // 419, 421, 431, 433, 439, 443, 449, 457, 461, 463, 467, 479, 487, 491, 499, 503,
+    // 509, 521, 523, 541
+};
+static const size_t MR_BASE_COUNT = sizeof(MR_BASES) / sizeof(MR_BASES[0]);
+
+// Các kiểm tra rẻ trước Miller-Rabin: trả về 0/1 nếu đã biết kết quả, -1 nếu cần chạy MR
+static int prime_precheck(const BigInt &n)
+{
+    if (n < 2u)
+        return 0;
+    if (n == 2u || n == 3u)
+        return 1;
+    if (is_even(n) || n % 3u == 0)
+        return 0;
+    return -1;
+}
+
+// isPrime có thể hủy: MR_CANCELLED khi *cancel được bật giữa một vòng
+static MRResult is_prime_cancellable(const BigInt &n, const atomic<bool> *cancel)
+{
+    int pre = prime_precheck(n);
+    if (pre >= 0)
+        return pre == 1 ? MR_PROBABLE_PRIME : MR_COMPOSITE;
+    for (uint32_t a : MR_BASES)
     {
-        x = (x * x) % n;
-        if (x == n - BigInt(1))
-            return true;
-        if (x == BigInt(1))
-            return false;
+        MRResult r = miller_rabin_round(n, BigInt(a), cancel);
+        if (r != MR_PROBABLE_PRIME)
+            return r;
     }
-    return false;
+    return MR_PROBABLE_PRIME;
 }
+
 bool isPrime(const BigInt &n)
 {
-     if (n < BigInt(2))
-        return false;
-    if (n == BigInt(2) || n == BigInt(3))
-        return true;
-    if (is_even(n) || n % BigInt(3) == BigInt(0))
-        return false;
-    // Expanded list of small prime bases for Miller-Rabin (many bases to increase confidence for large sizes)
-    std::vector<BigInt> primes = {
-        BigInt(2), BigInt(3), BigInt(5), BigInt(7), BigInt(11), BigInt(13), BigInt(17), BigInt(19),
-        BigInt(23), BigInt(29), BigInt(31), BigInt(37), BigInt(41), BigInt(43), BigInt(47), BigInt(53)
-        // BigInt(59), BigInt(61), BigInt(67), BigInt(71), BigInt(73), BigInt(79), BigInt(83), BigInt(89),
-        // BigInt(97), BigInt(101), BigInt(103), BigInt(107), BigInt(109), BigInt(113), BigInt(127), BigInt(131),
-        // BigInt(137), BigInt(139), BigInt(149), BigInt(151), BigInt(157), BigInt(163), BigInt(167), BigInt(173),
-        // BigInt(179), BigInt(181), BigInt(191), BigInt(193), BigInt(197), BigInt(199), BigInt(211), BigInt(223),
-        // BigInt(227), BigInt(229), BigInt(233), BigInt(239), BigInt(241), BigInt(251), BigInt(257), BigInt(263),
-        // BigInt(269), BigInt(271), BigInt(277), BigInt(281), BigInt(283), BigInt(293), BigInt(307), BigInt(311),
-        // BigInt(313), BigInt(317), BigInt(331), BigInt(337), BigInt(347), BigInt(349), BigInt(353), BigInt(359),
-        // BigInt(367), BigInt(373), BigInt(379), BigInt(383), BigInt(389), BigInt(397), BigInt(401), BigInt(409),
-        // BigInt(419), BigInt(421), BigInt(431), BigInt(433), BigInt(439), BigInt(443), BigInt(449), BigInt(457),
-        // BigInt(461), BigInt(463), BigInt(467), BigInt(479), BigInt(487), BigInt(491), BigInt(499), BigInt(503),
-        // BigInt(509), BigInt(521), BigInt(523), BigInt(541)
-    };
-
-    for (const BigInt &a : primes)
+    return is_prime_cancellable(n, nullptr) == MR_PROBABLE_PRIME;
+}
+
+// Trạng thái chung của một lần isPrime_parallel. Được giữ bằng shared_ptr vì task
+// trợ giúp có thể bắt đầu chạy sau khi hàm gọi đã trả về.
+struct ParallelMRState
+{
+    BigInt n;
+    atomic<size_t> next{0};        // chỉ số base tiếp theo chưa ai nhận
+    atomic<bool> composite{false}; // đã có witness; các vòng còn lại tự hủy
+    mutex mu;
+    condition_variable cv;
+    size_t done = 0; // số base đã xử lý xong (kể cả bị bỏ qua/hủy)
+};
+
+static void parallel_mr_worker(const shared_ptr<ParallelMRState> &st)
+{
+    size_t i;
+    while ((i = st->next.fetch_add(1, memory_order_relaxed)) < MR_BASE_COUNT)
     {
-        if (!millerRabinTest(n, a))
-        {
-            return false;
-        }
+        if (!st->composite.load(memory_order_relaxed) &&
+            miller_rabin_round(st->n, BigInt(MR_BASES[i]), &st->composite) == MR_COMPOSITE)
+            st->composite.store(true, memory_order_relaxed);
+        lock_guard<mutex> lk(st->mu);
+        if (++st->done == MR_BASE_COUNT)
+            st->cv.notify_all();
     }
-    return true;
 }
+
+bool isPrime_parallel(const BigInt &n, ThreadPool &pool)
+{
+    int pre = prime_precheck(n);
+    if (pre >= 0)
+        return pre == 1;
+    auto st = make_shared<ParallelMRState>();
+    st->n = n;
+    size_t helpers = min(pool.size(), MR_BASE_COUNT - 1);
+    for (size_t i = 0; i < helpers; ++i)
+        pool.post([st]
+                  { parallel_mr_worker(st); });
+    // thread gọi cũng nhận base, nên vẫn tiến triển khi pool đang bận
+    parallel_mr_worker(st);
+    unique_lock<mutex> lk(st->mu);
+    st->cv.wait(lk, [&]
+                { return st->done == MR_BASE_COUNT; });
+    return !st->composite.load(memory_order_relaxed);
+}
+
+bool isPrime_parallel(const BigInt &n)
+{
+    static ThreadPool pool;
+    return isPrime_parallel(n, pool);
+}
+
 BigInt get_min_value_with_bit_size(int bit_size)
 {
     if (bit_size <= 0)
         return BigInt(0);
-    size_t words = (bit_size + 31) / 32;
     BigInt result(0);
-    result.data.assign(words, 0u);
-    size_t wi = size_t((bit_size - 1) / 32);
-    int bi = (bit_size - 1) % 32;
-    result.data[wi] = (1u << bi);
-    result.normalize();
-    printf("Min value with bit size %d: %s\n", bit_size, result.to_decimal().c_str());
+    result.set_bit(size_t(bit_size - 1));
     return result;
 }
 // B: Triển khai hàm sinh số nguyên tố ngẫu nhiên
@@ -113,8 +220,7 @@ BigInt generate_safe_prime(int bit_size)
     BigInt p;
     
     if (is_even(q))
-        q = q + BigInt(1);
-    int tries = 0;
+        q = q + 1u;
     while(true) {
         // if(tries > 1e9) {
         //     cout << "Tìm quá lâu, hãy nhập lại kích thước bit khác: " ;
@@ -125,87 +231,304 @@ BigInt generate_safe_prime(int bit_size)
         //     tries = 0;
         //     continue;
         // }
-        if (tries % 100000 == 0 && tries > 0) {
-            cout << "Đã thử" << tries << " lần \n";
-        }
-        if(q % BigInt(5) == BigInt(2)) {   // q = 2 (mod 5) -> p = 2q + 1 = 0 (mod 5) not prime
-            q = q + BigInt(2);
+        if(q % 5u == 2) {   // q = 2 (mod 5) -> p = 2q + 1 = 0 (mod 5) not prime
+            BIGINT_STAT_ADD(STAT_CANDIDATES_SIEVED, 1);
+            q = q + 2u;
             continue;
         }
-        if(bit_size > 3 && q % BigInt(7) == BigInt(3)) {  // q = 3 (mod 7) -> p = 2q + 1 = 0 (mod 7) not prime
-            q = q + BigInt(2);
+        if(bit_size > 3 && q % 7u == 3) {  // q = 3 (mod 7) -> p = 2q + 1 = 0 (mod 7) not prime
+            BIGINT_STAT_ADD(STAT_CANDIDATES_SIEVED, 1);
+            q = q + 2u;
             continue;
         }
+        BIGINT_STAT_ADD(STAT_CANDIDATES_TESTED, 1);
         if (isPrime(q)) {
-            p = q * BigInt(2) + BigInt(1);
+            p = q * 2u + 1u;
             if (isPrime(p))
-            {
-                cout << "Tried " << tries << " times to find safe prime.\n";
                 break;
-            }
         }
-        q = q + BigInt(2);
-        tries++;
+        q = q + 2u;
     }
     return p;
 }
 
-// C: Triển khai hàm sinh khóa riêng ngẫu nhiên
-BigInt generate_private_key(const BigInt &p)
+// Số ngẫu nhiên phân bố đều trong [0, limit]: sinh đúng limit.bit_length() bit rồi loại
+// nếu vượt limit (kỳ vọng < 2 lần thử). Word cao được sinh và so trước nên hầu hết
+// lần bị loại chỉ tốn một word, không cần phép chia nào.
+static BigInt random_at_most(const BigInt &limit, ChaCha20Rng &rng)
 {
-    // Khởi tạo bộ sinh số ngẫu nhiên
-    random_device rd;
-    mt19937_64 gen(rd());
-    uniform_int_distribution<uint64_t> dis;
+    int bits = int(limit.bit_length());
+    if (bits == 0)
+        return BigInt(0);
+    size_t words = size_t((bits + 31) / 32);
+    uint32_t top_mask = (bits % 32 == 0) ? 0xFFFFFFFFu : ((1u << (bits % 32)) - 1u);
+    uint32_t limit_top = limit.data[words - 1];
+    BigInt r;
+    r.data.assign(words, 0u);
+    for (;;)
+    {
+        uint32_t top = rng.next_u32() & top_mask;
+        if (top > limit_top)
+            continue;
+        rng.fill(r.data.data(), words - 1);
+        r.data[words - 1] = top;
+        if (top < limit_top || !(limit < r))
+            return r.normalize();
+    }
+}
 
-    BigInt private_key(0);
+// ===== Sinh số nguyên tố an toàn từ điểm xuất phát ngẫu nhiên =====
 
-    // Sinh số ngẫu nhiên cho mỗi phần tử 32-bit trong vector data
-    for (size_t i = 0; i < private_key.data.size(); ++i)
+// Số nguyên tố lẻ nhỏ dùng để sàng (3 .. SIEVE_PRIME_LIMIT), tạo một lần
+static const uint32_t SIEVE_PRIME_LIMIT = 65536;
+static const vector<uint32_t> &sieve_primes()
+{
+    static const vector<uint32_t> primes = []
     {
-        private_key.data[i] = dis(gen);
+        vector<uint32_t> out;
+        vector<bool> composite(SIEVE_PRIME_LIMIT + 1, false);
+        for (uint32_t i = 3; i <= SIEVE_PRIME_LIMIT; i += 2)
+        {
+            if (composite[i])
+                continue;
+            out.push_back(i);
+            for (uint32_t j = i * i; j <= SIEVE_PRIME_LIMIT; j += 2 * i)
+                composite[j] = true;
+        }
+        return out;
+    }();
+    return primes;
+}
+
+// Cây phần dư của sieve_primes(), dựng một lần: số dư của q0 theo mọi số nguyên tố
+// nhỏ chỉ tốn khoảng một phép nhân cỡ tích của chúng thay vì một phép chia mỗi số
+static const RemainderTree &sieve_tree()
+{
+    static const RemainderTree tree(sieve_primes());
+    return tree;
+}
+
+// Số ứng viên q (bước 2) trong một cửa sổ sàng
+static const uint32_t SIEVE_WINDOW = 4096;
+
+bool generate_safe_prime_random(int bit_size, ChaCha20Rng &rng, const atomic<bool> *cancel, BigInt &out)
+{
+    if (bit_size < 3)
+        throw runtime_error("generate_safe_prime_random: bit_size must be >= 3");
+    // p = 2q + 1 có đúng bit_size bit <=> q có đúng q_bits bit
+    const int q_bits = bit_size - 1;
+    const size_t words = size_t((q_bits + 31) / 32);
+    const int top = (q_bits - 1) % 32;
+    const uint32_t top_mask = (top == 31) ? 0xFFFFFFFFu : ((2u << top) - 1u);
+
+    // Chỉ sàng bằng các số nguyên tố nhỏ hơn mọi q có thể có (q >= 2^(q_bits-1)),
+    // để không loại nhầm chính q = s hay p = s khi bit_size rất nhỏ
+    vector<uint32_t> primes;
+    for (uint32_t sp : sieve_primes())
+        if (q_bits - 1 >= 32 || sp < (1u << (q_bits - 1)))
+            primes.push_back(sp);
+    const RemainderTree *tree = &sieve_tree();
+    RemainderTree small_tree;
+    if (primes.size() < sieve_primes().size())
+    {
+        small_tree = RemainderTree(primes);
+        tree = &small_tree;
+    }
+    vector<uint32_t> residues;
+
+    vector<uint8_t> dead(SIEVE_WINDOW);
+    BigInt q, p; // ứng viên, buffer dùng lại qua mọi k
+    for (;;)
+    {
+        if (cancel && cancel->load(memory_order_relaxed))
+            return false;
+        // Điểm xuất phát: q0 lẻ ngẫu nhiên, bit cao nhất = 1
+        BigInt q0;
+        q0.data.assign(words, 0u);
+        rng.fill(q0.data.data(), words);
+        q0.data[words - 1] = (q0.data[words - 1] & top_mask) | (1u << top);
+        q0.data[0] |= 1u;
+        q0.normalize();
+
+        // Cửa sổ q = q0 + 2k, k < SIEVE_WINDOW. Với mỗi s, loại k khi s | q hoặc s | 2q + 1:
+        //   2k = -r (mod s)            -> k = (s - r) * inv2
+        //   2k = (s - 1)/2 - r (mod s) -> k = ((s - 1)/2 + s - r) * inv2
+        // với r = q0 mod s và inv2 = (s + 1)/2 là nghịch đảo của 2 mod s.
+        fill(dead.begin(), dead.end(), uint8_t(0));
+        tree->residues(q0, residues);
+        for (size_t i = 0; i < primes.size(); ++i)
+        {
+            uint32_t sp = primes[i];
+            uint64_t r = residues[i];
+            uint64_t inv2 = (sp + 1) / 2;
+            uint64_t k1 = ((sp - r) % sp) * inv2 % sp;
+            uint64_t k2 = ((sp - 1) / 2 + sp - r) % sp * inv2 % sp;
+            for (uint64_t k = k1; k < SIEVE_WINDOW; k += sp)
+                dead[k] = 1;
+            for (uint64_t k = k2; k < SIEVE_WINDOW; k += sp)
+                dead[k] = 1;
+        }
+
+        for (uint32_t k = 0; k < SIEVE_WINDOW; ++k)
+        {
+            if (dead[k])
+            {
+                BIGINT_STAT_ADD(STAT_CANDIDATES_SIEVED, 1);
+                continue;
+            }
+            q = q0 + 2 * k;
+            if (int(q.bit_length()) > q_bits)
+                break; // vượt quá độ dài bit: bốc điểm xuất phát mới
+            BIGINT_STAT_ADD(STAT_CANDIDATES_TESTED, 1);
+            // Một vòng base 2 cho cả q và p trước để loại nhanh, rồi mới kiểm tra đầy đủ
+            p = q * 2u + 1u;
+            MRResult r = q > 3u ? miller_rabin_round(q, BigInt(2), cancel) : MR_PROBABLE_PRIME;
+            if (r == MR_PROBABLE_PRIME && p > 3u)
+                r = miller_rabin_round(p, BigInt(2), cancel);
+            if (r == MR_PROBABLE_PRIME)
+                r = is_prime_cancellable(q, cancel);
+            if (r == MR_PROBABLE_PRIME)
+                r = is_prime_cancellable(p, cancel);
+            if (r == MR_CANCELLED)
+                return false;
+            if (r == MR_PROBABLE_PRIME)
+            {
+                out = std::move(p);
+                return true;
+            }
+        }
+    }
+}
+
+BigInt generate_safe_prime_random(int bit_size, ChaCha20Rng &rng)
+{
+    BigInt p;
+    generate_safe_prime_random(bit_size, rng, nullptr, p);
+    return p;
+}
+
+BigInt generate_safe_prime_random(int bit_size)
+{
+    return generate_safe_prime_random(bit_size, ChaCha20Rng::thread_local_instance());
+}
+
+BigInt generate_private_key(const BigInt &p, int exponent_bits, ChaCha20Rng &rng)
+{
+    if (p <= 4u)
+        throw runtime_error("generate_private_key: p must be > 4");
+    int p_bits = int(p.bit_length());
+    if (exponent_bits > 0 && exponent_bits < p_bits - 1)
+    {
+        // Short exponent: đúng exponent_bits bit (bit cao nhất = 1), luôn < 2^(p_bits-2) < p-2
+        if (exponent_bits < 2)
+            exponent_bits = 2;
+        size_t words = size_t((exponent_bits + 31) / 32);
+        BigInt key;
+        key.data.assign(words, 0u);
+        rng.fill(key.data.data(), words);
+        int top = (exponent_bits - 1) % 32;
+        key.data[words - 1] &= (top == 31) ? 0xFFFFFFFFu : ((2u << top) - 1u);
+        key.data[words - 1] |= (1u << top);
+        return key;
     }
+    // Toàn dải: đều trong [2, p-2] = 2 + [0, p-4]
+    return random_at_most(p - 4u, rng) + 2u;
+}
 
-    // Đảm bảo private_key nằm trong khoảng [2, p-2]
-    BigInt p_minus_2 = p - BigInt(2);
-    private_key = private_key % p_minus_2;
-    private_key = private_key + BigInt(2);
+// C: Triển khai hàm sinh khóa riêng ngẫu nhiên
+BigInt generate_private_key(const BigInt &p, int exponent_bits)
+{
+    return generate_private_key(p, exponent_bits, ChaCha20Rng::thread_local_instance());
+}
 
-    return private_key;
+DHGroup load_or_create_group(DHGroupStore &store, const string &spec)
+{
+    DHGroup group;
+    if (store.find(spec, group))
+        return group;
+    if (builtin_dh_group(spec, group))
+    {
+        store.append(group);
+        return group;
+    }
+    int bits = 0;
+    for (char c : spec)
+    {
+        if (c < '0' || c > '9' || bits > 1000000)
+            throw runtime_error("load_or_create_group: unknown group '" + spec + "'");
+        bits = bits * 10 + (c - '0');
+    }
+    if (bits < 3)
+        throw runtime_error("load_or_create_group: unknown group '" + spec + "'");
+    if (store.find(bits, group))
+        return group;
+    BigInt p = generate_safe_prime_random(bits);
+    group = make_dh_group("safe" + spec, p, default_generator(p));
+    store.append(group);
+    return group;
 }
 
 // D: Hoàn thành logic trao đổi khóa Diffie-Hellman
 
 #ifndef UNIT_TEST
-int main()
+int main(int argc, char **argv)
 {
-    // 1. Sinh số nguyên tố lớn p và phần tử sinh g
-    int bit_size = 32; // Kích thước bit ví dụ, có thể điều chỉnh
-    printf("Enter bit size for prime p: ");
-    cin >> bit_size;
-    BigInt p = generate_safe_prime(bit_size); // Sinh một số nguyên tố
-    BigInt g = BigInt(2);                     // Phần tử sinh, sinh viên cần tìm hiểu và chọn giá trị khác
+    // Có tham số dòng lệnh: chế độ sinh tải (LoadGen.h); không có: một lần trao đổi tương tác
+    if (argc > 1)
+        return run_load_generator(argc, argv);
 
-    printf("Generated safe prime p: %s\n", p.to_decimal().c_str());
+    // 1. Lấy nhóm (p, g): từ kho DH_GROUP_CACHE (mặc định dh_groups.bin) nếu đã có,
+    //    ngược lại sinh số nguyên tố an toàn mới / dựng nhóm RFC rồi lưu vào kho
+    string spec = "32"; // số bit hoặc tên nhóm dựng sẵn, ví dụ modp2048
+    printf("Enter bit size for prime p (or group name, e.g. modp2048): ");
+    cin >> spec;
+    const char *cache = getenv("DH_GROUP_CACHE");
+    DHGroup group;
+    try
+    {
+        DHGroupStore store(cache && *cache ? cache : "dh_groups.bin");
+        group = load_or_create_group(store, spec);
+    }
+    catch (const exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    const BigInt &p = group.p;
+    const BigInt &g = group.g; // phần tử sinh của nhóm con bậc q
+
+    printf("Using group %s (%d bits)\n", group.name.c_str(), group.bits);
+    printf("Safe prime p: %s\n", p.to_decimal().c_str());
     printf("Using generator g: %s\n", g.to_decimal().c_str());
 
     // 2. Sinh khóa riêng của Alice và Bob
     BigInt a = generate_private_key(p); // Khóa riêng của Alice
     BigInt b = generate_private_key(p); // Khóa riêng của Bob
 
-    // 3. Tính giá trị công khai của Alice và Bob
-    BigInt A = modular_exponentiation(g, a, p); // Alice tính A = g^a % p
-    BigInt B = modular_exponentiation(g, b, p); // Bob tính B = g^b % p
+    // 3. Tính giá trị công khai của Alice và Bob (bảng lũy thừa cố định của g)
+    BigInt A = group.pow_g(a); // Alice tính A = g^a % p
+    BigInt B = group.pow_g(b); // Bob tính B = g^b % p
+
+    // 4. Mỗi bên kiểm tra giá trị công khai nhận được trước khi dùng
+    DHKeyCheck check_B = check_public_value(group, B); // Alice kiểm tra B
+    DHKeyCheck check_A = check_public_value(group, A); // Bob kiểm tra A
+    printf("Alice checks B: %s\n", dh_key_check_name(check_B));
+    printf("Bob checks A: %s\n", dh_key_check_name(check_A));
+    if (check_A != DH_KEY_OK || check_B != DH_KEY_OK)
+        return 1;
 
-    // 4. Tính bí mật chung
-    BigInt alice_shared_secret = modular_exponentiation(B, a, p); // Alice tính s = B^a % p
-    BigInt bob_shared_secret = modular_exponentiation(A, b, p);   // Bob tính s = A^b % p
+    // 5. Tính bí mật chung
+    BigInt alice_shared_secret = group.pow(B, a); // Alice tính s = B^a % p
+    BigInt bob_shared_secret = group.pow(A, b);   // Bob tính s = A^b % p
 
-    // 5. Hiển thị kết quả và xác minh rằng bí mật chung trùng khớp
+    // 6. Hiển thị kết quả và xác minh rằng bí mật chung trùng khớp
     std::cout << "Bi mat chung Alice nhan duoc: " << alice_shared_secret << "\n";
     std::cout << "Bi mat chung Bob nhan duoc: " << bob_shared_secret << "\n";
     std::cout << "Qua trinh tinh toan dung khong? " << (alice_shared_secret == bob_shared_secret) << "\n";
 
+    if (bigint_stats_enabled())
+        bigint_stats_dump(std::cerr, bigint_stats_snapshot());
+
     return 0;
 }
 #endif
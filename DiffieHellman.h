@@ -0,0 +1,49 @@
+// DiffieHellman.h
+// Các hàm Diffie-Hellman cài đặt trong DiffieHellman.cpp
+#pragma once
+#include <atomic>
+#include "BigInt.h"
+
+class ThreadPool;
+class ChaCha20Rng;
+class DHGroupStore;
+struct DHGroup;
+
+// (base^exponent) % mod; base và exponent có thể là view lên buffer ngoài
+BigInt modular_exponentiation(BigIntView base, BigIntView exponent, const BigInt &mod);
+
+// Một vòng Miller-Rabin với base a; false nghĩa là n chắc chắn là hợp số
+bool millerRabinTest(const BigInt &n, const BigInt &a);
+// Miller-Rabin với 16 base nguyên tố đầu tiên, chạy tuần tự
+bool isPrime(const BigInt &n);
+// Giống isPrime nhưng các base chạy song song trên pool; dừng các vòng còn lại
+// ngay khi một base chứng minh n là hợp số. Thread gọi cũng tham gia chạy base,
+// nên có thể gọi từ bên trong một task của chính pool mà không bị deadlock.
+bool isPrime_parallel(const BigInt &n, ThreadPool &pool);
+// Dùng pool mặc định (số thread = số core), tạo lần đầu khi được gọi
+bool isPrime_parallel(const BigInt &n);
+
+BigInt get_min_value_with_bit_size(int bit_size);
+// Số nguyên tố an toàn p = 2q + 1 có bit_size bit
+BigInt generate_safe_prime(int bit_size);
+// Như generate_safe_prime nhưng bắt đầu từ q lẻ ngẫu nhiên (bit cao nhất bật để p có đúng
+// bit_size bit) và sàng từng cửa sổ 4096 ứng viên bằng các số nguyên tố nhỏ < 65536, loại
+// cả q lẫn 2q+1 chia hết; số dư của điểm xuất phát theo các số nguyên tố này lấy từ một
+// RemainderTree dựng sẵn. Mỗi lần gọi / mỗi thread khám phá một vùng độc lập; số ứng viên
+// cần thử kỳ vọng tỉ lệ với bit_size^2 theo định lý số nguyên tố, không phụ thuộc vị trí
+// của số nguyên tố an toàn đầu tiên sau 2^(bit_size-2).
+BigInt generate_safe_prime_random(int bit_size, ChaCha20Rng &rng);
+BigInt generate_safe_prime_random(int bit_size); // DRBG của thread hiện tại
+// Bản có thể hủy: trả về false (out giữ nguyên) khi *cancel được bật giữa chừng. Cờ được
+// kiểm tra sau mỗi bit của mỗi modexp trong Miller-Rabin nên hủy có hiệu lực gần như ngay.
+bool generate_safe_prime_random(int bit_size, ChaCha20Rng &rng, const std::atomic<bool> *cancel, BigInt &out);
+// Khóa riêng phân bố đều trong [2, p-2], lấy từ DRBG ChaCha20 của thread hiện tại.
+// exponent_bits > 0 (và < bit_length(p) - 1): short exponent có đúng exponent_bits bit,
+// ví dụ 256 bit cho nhóm 2048 bit để modexp rẻ hơn khoảng 8 lần.
+BigInt generate_private_key(const BigInt &p, int exponent_bits = 0);
+BigInt generate_private_key(const BigInt &p, int exponent_bits, ChaCha20Rng &rng);
+
+// Lấy nhóm từ kho theo spec: tên nhóm dựng sẵn ("modp2048", "ffdhe3072", ...) hoặc số bit.
+// Nếu kho chưa có thì dựng (với số bit: sinh số nguyên tố an toàn mới, g = default_generator)
+// rồi append vào kho để lần chạy sau chỉ cần mmap.
+DHGroup load_or_create_group(DHGroupStore &store, const std::string &spec);
@@ -4,11 +4,9 @@
 #include <string>
 #include <vector>
 #include "BigInt.h"
-
-// Forward declarations from DiffieHellman.cpp
-BigInt modular_exponentiation(const BigInt &base, const BigInt &exponent, const BigInt &mod);
-bool isPrime(const BigInt &n);
-BigInt generate_safe_prime(int bit_size);
+#include "DiffieHellman.h"
+#include "ThreadPool.h"
+#include "ChaCha20.h"
 
 using namespace std;
 
@@ -101,6 +99,23 @@ int main()
     for (auto &s : comps)
         expect_true(!isPrime(BigInt(s)), (string("isPrime(") + s + ") should be false").c_str());
 
+    // 3b) isPrime_parallel agrees with isPrime, including strong pseudoprimes to
+    // base 2 (2047, 3215031751) and Carmichael numbers (561, 41041)
+    ThreadPool pool(4);
+    vector<string> mixed = {"2", "3", "4", "9", "561", "2047", "41041", "65537", "3215031751",
+                            "170141183460469231731687303715884105727",  // 2^127-1 (prime)
+                            "170141183460469231731687303715884105729"}; // 2^127+1 (composite)
+    for (auto &s : mixed)
+    {
+        bool seq = isPrime(BigInt(s));
+        expect_true(isPrime_parallel(BigInt(s), pool) == seq,
+                    (string("isPrime_parallel(") + s + ") matches isPrime").c_str());
+        expect_true(isPrime_parallel(BigInt(s)) == seq,
+                    (string("isPrime_parallel(") + s + ") with default pool matches isPrime").c_str());
+    }
+    expect_true(isPrime_parallel(BigInt("170141183460469231731687303715884105727"), pool), "2^127-1 is prime (parallel)");
+    expect_true(!isPrime_parallel(BigInt("3215031751"), pool), "3215031751 is composite (parallel)");
+
     // 4) generate_safe_prime small bit size (fast)
     int bit_size = 16; // small for tests
     BigInt p = generate_safe_prime(bit_size);
@@ -113,6 +128,28 @@ int main()
     BigInt check = q + q + BigInt(1);
     expect_true(check == p, "p == 2*q + 1");
 
+    // 4b) generate_safe_prime_random: exact bit length, safe prime, independent runs
+    {
+        const uint32_t seed_key[8] = {11, 22, 33, 44, 55, 66, 77, 88};
+        ChaCha20Rng rng(seed_key, 1);
+        bool ok = true;
+        for (int bits = 3; bits <= 40; ++bits)
+        {
+            BigInt sp = generate_safe_prime_random(bits, rng);
+            BigInt sq = (sp - BigInt(1)).shr_bits(1);
+            ok = ok && sp >= BigInt(1).shl_bits(bits - 1) && sp < BigInt(1).shl_bits(bits);
+            ok = ok && isPrime(sp) && isPrime(sq);
+        }
+        expect_true(ok, "random-start safe primes for 3..40 bits have exact length and are safe");
+        BigInt r1 = generate_safe_prime_random(128, rng);
+        BigInt r2 = generate_safe_prime_random(128, rng);
+        expect_true(!(r1 == r2), "two random-start searches land on different primes");
+        ChaCha20Rng again(seed_key, 1);
+        ChaCha20Rng again2(seed_key, 1);
+        expect_true(generate_safe_prime_random(64, again) == generate_safe_prime_random(64, again2),
+                    "same DRBG seed reproduces the same prime");
+    }
+
     // 5) small Diffie-Hellman exchange
     // Using safe small prime 23, generator 5 (common classroom example)
     BigInt p23("23"), g5("5");
@@ -131,6 +168,58 @@ int main()
         cout << "ok: DH shared secret equal (23,5,a=6,b=15)" << "\n";
     }
 
+    // 6) ChaCha20 block function, RFC 7539 section 2.3.2 test vector
+    {
+        uint32_t key[8];
+        for (int i = 0; i < 8; ++i)
+            key[i] = uint32_t(4 * i) | uint32_t(4 * i + 1) << 8 | uint32_t(4 * i + 2) << 16 | uint32_t(4 * i + 3) << 24;
+        const uint32_t input[4] = {1u, 0x09000000u, 0x4a000000u, 0u};
+        const uint32_t expected[16] = {0xe4e7f110u, 0x15593bd1u, 0x1fdd0f50u, 0xc47120a3u,
+                                       0xc7f4d1c7u, 0x0368c033u, 0x9aaa2204u, 0x4e6cd4c3u,
+                                       0x466482d2u, 0x09aa9f07u, 0x05d7c214u, 0xa2028bd9u,
+                                       0xd19c12b5u, 0xb94e16deu, 0xe883d0cbu, 0x4e3c50a2u};
+        uint32_t out[16];
+        chacha20_block(key, input, out);
+        bool same = true;
+        for (int i = 0; i < 16; ++i)
+            same = same && out[i] == expected[i];
+        expect_true(same, "chacha20_block matches RFC 7539 2.3.2");
+    }
+
+    // 7) generate_private_key: range, uniform coverage, short exponents
+    {
+        const uint32_t seed_key[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+        ChaCha20Rng rng(seed_key, 42);
+        vector<int> seen(23, 0);
+        bool in_range = true;
+        for (int i = 0; i < 2000; ++i)
+        {
+            BigInt k = generate_private_key(p23, 0, rng);
+            in_range = in_range && k >= BigInt(2) && k <= BigInt(21);
+            if (k <= BigInt(22))
+                seen[k.data[0]]++;
+        }
+        expect_true(in_range, "private keys for p=23 lie in [2, 21]");
+        bool all_hit = true;
+        for (int v = 2; v <= 21; ++v)
+            all_hit = all_hit && seen[v] > 0;
+        expect_true(all_hit, "every value in [2, 21] is generated");
+
+        BigInt p2048 = BigInt(1).shl_bits(2047) + BigInt(1); // 2048-bit modulus
+        bool full_ok = true, short_ok = true;
+        for (int i = 0; i < 20; ++i)
+        {
+            BigInt k = generate_private_key(p2048, 0, rng);
+            full_ok = full_ok && k >= BigInt(2) && k <= p2048 - BigInt(2) && k.data.size() > 1;
+            BigInt s = generate_private_key(p2048, 256, rng);
+            short_ok = short_ok && s.data.size() == 8 && (s.data[7] >> 31) == 1u;
+        }
+        expect_true(full_ok, "full-range keys for 2048-bit p span more than one word and stay <= p-2");
+        expect_true(short_ok, "256-bit short exponents have exactly 256 bits");
+        BigInt dflt = generate_private_key(p2048);
+        expect_true(dflt >= BigInt(2) && dflt <= p2048 - BigInt(2), "thread-local DRBG key in range");
+    }
+
     cout << "All Diffie-Hellman tests passed.\n";
     return 0;
 }
@@ -0,0 +1,116 @@
+// LatencyHistogram.h
+// Histogram độ trễ (nano giây) kiểu log-tuyến tính: mỗi khoảng [2^k, 2^(k+1)) chia thành
+// 16 bucket đều nhau, nên sai số tương đối của phân vị <= 1/16. Ghi bằng một phép cộng
+// atomic relaxed, an toàn khi nhiều thread cùng ghi; đọc trả về bản chụp.
+#pragma once
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+class LatencyHistogram
+{
+public:
+    static const int SUB_BITS = 4;                        // 16 bucket con mỗi lũy thừa 2
+    static const int SUB_COUNT = 1 << SUB_BITS;
+    static const int MAX_POW = 44;                        // > 2^44 ns (~4.9 giờ) gộp vào bucket cuối
+    static const int BUCKETS = (MAX_POW - SUB_BITS + 1) * SUB_COUNT + SUB_COUNT;
+
+    struct Snapshot
+    {
+        std::array<uint64_t, BUCKETS> counts{};
+        uint64_t count = 0;
+        uint64_t sum_ns = 0;
+        uint64_t max_ns = 0;
+
+        double mean_ns() const { return count ? double(sum_ns) / double(count) : 0.0; }
+        // Phân vị q trong [0, 1], trả về cận trên của bucket chứa nó (không vượt max)
+        uint64_t percentile_ns(double q) const
+        {
+            if (count == 0)
+                return 0;
+            uint64_t rank = uint64_t(q * double(count));
+            if (rank >= count)
+                rank = count - 1;
+            uint64_t seen = 0;
+            for (int i = 0; i < BUCKETS; ++i)
+            {
+                seen += counts[i];
+                if (seen > rank)
+                {
+                    uint64_t hi = bucket_upper(i);
+                    return hi < max_ns ? hi : max_ns;
+                }
+            }
+            return max_ns;
+        }
+        void merge(const Snapshot &o)
+        {
+            for (int i = 0; i < BUCKETS; ++i)
+                counts[i] += o.counts[i];
+            count += o.count;
+            sum_ns += o.sum_ns;
+            if (o.max_ns > max_ns)
+                max_ns = o.max_ns;
+        }
+    };
+
+    void record(uint64_t ns)
+    {
+        counts_[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t m = max_.load(std::memory_order_relaxed);
+        while (ns > m && !max_.compare_exchange_weak(m, ns, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    Snapshot snapshot() const
+    {
+        Snapshot s;
+        for (int i = 0; i < BUCKETS; ++i)
+            s.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        s.count = count_.load(std::memory_order_relaxed);
+        s.sum_ns = sum_.load(std::memory_order_relaxed);
+        s.max_ns = max_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void reset()
+    {
+        for (auto &c : counts_)
+            c.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    // Giá trị < 16 ns nằm thẳng ở bucket 0..15; còn lại theo (lũy thừa, 4 bit kế tiếp)
+    static int bucket_of(uint64_t ns)
+    {
+        if (ns < uint64_t(SUB_COUNT))
+            return int(ns);
+        int msb = 63 - __builtin_clzll(ns);
+        if (msb > MAX_POW)
+            return BUCKETS - 1;
+        int sub = int((ns >> (msb - SUB_BITS)) & (SUB_COUNT - 1));
+        return (msb - SUB_BITS + 1) * SUB_COUNT + sub;
+    }
+
+    static uint64_t bucket_upper(int i)
+    {
+        if (i < SUB_COUNT)
+            return uint64_t(i);
+        int msb = i / SUB_COUNT + SUB_BITS - 1;
+        uint64_t sub = uint64_t(i % SUB_COUNT);
+        uint64_t width = uint64_t(1) << (msb - SUB_BITS);
+        return (uint64_t(1) << msb) + (sub + 1) * width - 1;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
@@ -0,0 +1,328 @@
+// LoadGen.cpp
+#include "LoadGen.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <sys/resource.h>
+#include "BigInt.h"
+#include "DiffieHellman.h"
+#include "DHGroupStore.h"
+#include "DHValidate.h"
+#include "LatencyHistogram.h"
+
+using namespace std;
+
+struct LoadGenOptions
+{
+    string group = "modp2048";
+    size_t threads = 0;
+    double duration = 10.0;
+    int key_bits = 0;
+    double interval = 1.0;
+    bool validate = true;
+    string out;
+};
+
+// Giới hạn giá trị tùy chọn: chặn --threads lớn vô lý (ví dụ -1 đọc thành size_t) trước khi tạo luồng
+static const unsigned long MAX_LOADGEN_THREADS = 1024;
+static const unsigned long MAX_LOADGEN_KEY_BITS = 1u << 20;
+
+static void print_loadgen_usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [--group=NAME|BITS] [--threads=N] [--duration=SEC] [--key-bits=N]\n"
+            "          [--interval=SEC] [--no-validate] [--out=FILE]\n"
+            "  --group     nhóm dựng sẵn (modp2048, ffdhe3072, ...) hoặc số bit (lấy từ DH_GROUP_CACHE)\n"
+            "  --threads   số luồng, 1..%lu (0: số lõi)\n"
+            "  --key-bits  độ dài khóa riêng (0: toàn dải [2, p-2])\n",
+            prog, MAX_LOADGEN_THREADS);
+}
+
+// Số nguyên không âm trong [0, max]; từ chối chuỗi rỗng, dấu, ký tự thừa và tràn
+static bool parse_count(const char *v, unsigned long max, unsigned long &out)
+{
+    if (*v < '0' || *v > '9')
+        return false;
+    char *end = nullptr;
+    errno = 0;
+    unsigned long x = strtoul(v, &end, 10);
+    if (errno != 0 || *end != '\0' || x > max)
+        return false;
+    out = x;
+    return true;
+}
+
+// Số giây hữu hạn, không âm
+static bool parse_seconds(const char *v, double &out)
+{
+    if (*v == '\0' || *v == '-')
+        return false;
+    char *end = nullptr;
+    errno = 0;
+    double x = strtod(v, &end);
+    if (errno != 0 || *end != '\0' || !isfinite(x) || x < 0)
+        return false;
+    out = x;
+    return true;
+}
+
+static bool parse_loadgen_args(int argc, char **argv, LoadGenOptions &opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        auto value = [&](const char *prefix) -> const char *
+        {
+            size_t len = string(prefix).size();
+            return arg.compare(0, len, prefix) == 0 ? argv[i] + len : nullptr;
+        };
+        bool ok = true;
+        unsigned long n = 0;
+        if (const char *v = value("--group="))
+            opt.group = v;
+        else if (const char *v = value("--threads="))
+        {
+            ok = parse_count(v, MAX_LOADGEN_THREADS, n);
+            opt.threads = size_t(n);
+        }
+        else if (const char *v = value("--duration="))
+            ok = parse_seconds(v, opt.duration);
+        else if (const char *v = value("--key-bits="))
+        {
+            ok = parse_count(v, MAX_LOADGEN_KEY_BITS, n);
+            opt.key_bits = int(n);
+        }
+        else if (const char *v = value("--interval="))
+            ok = parse_seconds(v, opt.interval);
+        else if (const char *v = value("--out="))
+            opt.out = v;
+        else if (arg == "--no-validate")
+            opt.validate = false;
+        else
+        {
+            fprintf(stderr, "unknown option: %s\n", argv[i]);
+            print_loadgen_usage(argv[0]);
+            return false;
+        }
+        if (!ok)
+        {
+            fprintf(stderr, "invalid value: %s\n", argv[i]);
+            print_loadgen_usage(argv[0]);
+            return false;
+        }
+    }
+    if (opt.duration <= 0)
+    {
+        fprintf(stderr, "--duration must be > 0\n");
+        print_loadgen_usage(argv[0]);
+        return false;
+    }
+    if (opt.threads == 0)
+        opt.threads = thread::hardware_concurrency();
+    if (opt.threads == 0)
+        opt.threads = 1;
+    if (opt.interval <= 0)
+        opt.interval = opt.duration;
+    return true;
+}
+
+struct LoadGenHistograms
+{
+    LatencyHistogram handshake; // một trao đổi khóa đầy đủ, cả hai phía
+    LatencyHistogram keygen;    // sinh khóa riêng + g^x
+    LatencyHistogram validate;  // kiểm tra khóa công khai nhận được
+    LatencyHistogram derive;    // B^x
+};
+
+static uint64_t elapsed_ns(chrono::steady_clock::time_point from)
+{
+    return uint64_t(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - from).count());
+}
+
+// Một phía của trao đổi khóa
+static void timed_keygen(const DHGroup &g, int key_bits, LoadGenHistograms &h, BigInt &priv, BigInt &pub)
+{
+    auto t0 = chrono::steady_clock::now();
+    priv = generate_private_key(g.p, key_bits);
+    pub = g.pow_g(priv);
+    h.keygen.record(elapsed_ns(t0));
+}
+
+static bool timed_derive(const DHGroup &g, bool validate, LoadGenHistograms &h,
+                         const BigInt &peer, const BigInt &priv, BigInt &secret)
+{
+    if (validate)
+    {
+        auto t0 = chrono::steady_clock::now();
+        bool ok = check_public_value(g, peer) == DH_KEY_OK;
+        h.validate.record(elapsed_ns(t0));
+        if (!ok)
+            return false;
+    }
+    auto t0 = chrono::steady_clock::now();
+    secret = g.pow(peer, priv);
+    h.derive.record(elapsed_ns(t0));
+    return true;
+}
+
+static void loadgen_worker(const DHGroup &g, const LoadGenOptions &opt, LoadGenHistograms &h,
+                           const atomic<bool> &stop, atomic<uint64_t> &mismatches)
+{
+    BigInt a, A, b, B, s1, s2;
+    while (!stop.load(memory_order_relaxed))
+    {
+        auto t0 = chrono::steady_clock::now();
+        timed_keygen(g, opt.key_bits, h, a, A); // phía mình
+        timed_keygen(g, opt.key_bits, h, b, B); // peer giả lập
+        bool ok = timed_derive(g, opt.validate, h, B, a, s1) &&
+                  timed_derive(g, opt.validate, h, A, b, s2) && s1 == s2;
+        h.handshake.record(elapsed_ns(t0));
+        if (!ok)
+            mismatches.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+static double cpu_seconds()
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return double(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+           double(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1e-6;
+}
+
+static double ms(uint64_t ns)
+{
+    return double(ns) * 1e-6;
+}
+
+static void print_summary_line(const char *name, const LatencyHistogram::Snapshot &s, double wall)
+{
+    printf("%-10s %10llu %12.1f %10.3f %10.3f %10.3f %10.3f %10.3f\n", name, (unsigned long long)s.count,
+           wall > 0 ? double(s.count) / wall : 0.0, ms(uint64_t(s.mean_ns())), ms(s.percentile_ns(0.5)),
+           ms(s.percentile_ns(0.99)), ms(s.percentile_ns(0.999)), ms(s.max_ns));
+}
+
+static void write_json_op(ofstream &f, const char *name, const LatencyHistogram::Snapshot &s, double wall, bool last)
+{
+    f << "    \"" << name << "\": {\"count\": " << s.count
+      << ", \"per_second\": " << (wall > 0 ? double(s.count) / wall : 0.0)
+      << ", \"mean_ns\": " << uint64_t(s.mean_ns())
+      << ", \"p50_ns\": " << s.percentile_ns(0.5)
+      << ", \"p99_ns\": " << s.percentile_ns(0.99)
+      << ", \"p999_ns\": " << s.percentile_ns(0.999)
+      << ", \"max_ns\": " << s.max_ns << "}" << (last ? "\n" : ",\n");
+}
+
+int run_load_generator(int argc, char **argv)
+{
+    LoadGenOptions opt;
+    if (!parse_loadgen_args(argc, argv, opt))
+        return 2;
+
+    const char *cache = getenv("DH_GROUP_CACHE");
+    DHGroup group;
+    try
+    {
+        DHGroupStore store(cache && *cache ? cache : "dh_groups.bin");
+        group = load_or_create_group(store, opt.group);
+    }
+    catch (const exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+
+    printf("group=%s (%d bits) threads=%zu duration=%.1fs key_bits=%s validate=%s mul_backend=%s\n",
+           group.name.c_str(), group.bits, opt.threads, opt.duration,
+           opt.key_bits > 0 ? to_string(opt.key_bits).c_str() : "full", opt.validate ? "on" : "off",
+           bigint_mul_backend());
+    printf("context: constants=%zu B table=%zu B (window=%d, exp_bits=%d, %zu entries)\n", group.constants_bytes(),
+           group.table_bytes(), group.table_window, group.table_exp_bits, group.table_entries);
+
+    LoadGenHistograms h;
+    atomic<bool> stop{false};
+    atomic<uint64_t> mismatches{0};
+    double cpu0 = cpu_seconds();
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (size_t i = 0; i < opt.threads; ++i)
+        workers.emplace_back([&]
+                             { loadgen_worker(group, opt, h, stop, mismatches); });
+
+    // Báo cáo theo từng khoảng: thông lượng của khoảng và p99 tích lũy
+    printf("%8s %12s %12s %12s\n", "time_s", "handshakes/s", "p99_ms", "cpu_cores");
+    uint64_t last_count = 0;
+    double last_cpu = cpu0, last_t = 0.0;
+    for (;;)
+    {
+        double now = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        double next = last_t + opt.interval;
+        if (next > opt.duration)
+            next = opt.duration;
+        if (now < next)
+            this_thread::sleep_for(chrono::duration<double>(next - now));
+        now = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        LatencyHistogram::Snapshot s = h.handshake.snapshot();
+        double cpu = cpu_seconds();
+        double dt = now - last_t;
+        printf("%8.1f %12.1f %12.3f %12.2f\n", now, dt > 0 ? double(s.count - last_count) / dt : 0.0,
+               ms(s.percentile_ns(0.99)), dt > 0 ? (cpu - last_cpu) / dt : 0.0);
+        fflush(stdout);
+        last_count = s.count;
+        last_cpu = cpu;
+        last_t = now;
+        if (now >= opt.duration)
+            break;
+    }
+    stop = true;
+    for (auto &t : workers)
+        t.join();
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double cpu = cpu_seconds() - cpu0;
+    unsigned hw = thread::hardware_concurrency();
+
+    LatencyHistogram::Snapshot hs = h.handshake.snapshot(), ks = h.keygen.snapshot(),
+                               vs = h.validate.snapshot(), ds = h.derive.snapshot();
+    printf("\n%-10s %10s %12s %10s %10s %10s %10s %10s\n", "op", "count", "ops/s", "mean_ms", "p50_ms", "p99_ms",
+           "p999_ms", "max_ms");
+    print_summary_line("handshake", hs, wall);
+    print_summary_line("keygen", ks, wall);
+    if (opt.validate)
+        print_summary_line("validate", vs, wall);
+    print_summary_line("derive", ds, wall);
+    double cores = wall > 0 ? cpu / wall : 0.0;
+    printf("\ncpu: %.2f s over %.2f s wall = %.2f cores (%.0f%% of %zu worker threads, %.0f%% of %u hardware threads)\n",
+           cpu, wall, cores, 100.0 * cores / double(opt.threads), opt.threads, hw ? 100.0 * cores / hw : 0.0, hw);
+    uint64_t bad = mismatches.load();
+    if (bad)
+        printf("ERROR: %llu handshakes failed (rejected public value or secret mismatch)\n", (unsigned long long)bad);
+
+    if (!opt.out.empty())
+    {
+        ofstream f(opt.out);
+        f << "{\n  \"context\": {\"group\": \"" << group.name << "\", \"bits\": " << group.bits
+          << ", \"threads\": " << opt.threads << ", \"duration_s\": " << wall
+          << ", \"key_bits\": " << opt.key_bits << ", \"validate\": " << (opt.validate ? "true" : "false")
+          << ", \"mul_backend\": \"" << bigint_mul_backend() << "\""
+          << ", \"constants_bytes\": " << group.constants_bytes() << ", \"table_bytes\": " << group.table_bytes()
+          << "},\n";
+        f << "  \"cpu\": {\"seconds\": " << cpu << ", \"cores\": " << cores
+          << ", \"hardware_threads\": " << hw << "},\n";
+        f << "  \"failures\": " << bad << ",\n  \"ops\": {\n";
+        write_json_op(f, "handshake", hs, wall, false);
+        write_json_op(f, "keygen", ks, wall, false);
+        write_json_op(f, "validate", vs, wall, false);
+        write_json_op(f, "derive", ds, wall, true);
+        f << "  }\n}\n";
+        printf("wrote %s\n", opt.out.c_str());
+    }
+    return bad ? 1 : 0;
+}
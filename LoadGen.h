@@ -0,0 +1,10 @@
+// LoadGen.h
+// Chế độ sinh tải của CLI dh: nhiều thread liên tục chạy trao đổi khóa đầy đủ (Alice và
+// một peer giả lập cục bộ cùng sinh khóa, kiểm tra khóa công khai của nhau, tính bí mật
+// chung), in thông lượng theo từng khoảng và tổng kết p50/p99/p999 cùng mức dùng CPU.
+//
+//   ./dh --group=modp2048 --threads=4 --duration=30 --key-bits=256
+#pragma once
+
+// Trả về mã thoát của tiến trình (0: thành công, 2: tham số sai, 1: bí mật chung lệch)
+int run_load_generator(int argc, char **argv);
@@ -0,0 +1,265 @@
+// Montgomery.cpp
+#include "Montgomery.h"
+#include <stdexcept>
+#include <cstring>
+
+using namespace std;
+
+// `count` bit của e bắt đầu từ bit `pos` (count <= 32)
+static uint32_t get_bits(BigIntView e, int pos, int count)
+{
+    size_t wi = size_t(pos / 32);
+    int bi = pos % 32;
+    uint64_t lo = e.word(wi);
+    uint64_t hi = e.word(wi + 1);
+    uint64_t v = ((hi << 32) | lo) >> bi;
+    return uint32_t(v & ((count == 32) ? 0xFFFFFFFFull : ((1ull << count) - 1ull)));
+}
+
+static BigInt from_words(const uint32_t *w, size_t n)
+{
+    BigInt r;
+    r.data.assign(w, w + n);
+    r.normalize();
+    return r;
+}
+
+MontgomeryContext::MontgomeryContext(const BigInt &modulus)
+{
+    n_ = modulus;
+    n_.normalize();
+    if ((n_.data[0] & 1u) == 0 || compare(n_, 1u) <= 0)
+        throw runtime_error("MontgomeryContext: modulus must be odd and > 1");
+    n_words_ = n_.data;
+
+    // Newton: x = n0^-1 mod 2^32, mỗi vòng gấp đôi số bit đúng (3 -> 6 -> 12 -> 24 -> 48)
+    uint32_t n0 = n_.data[0];
+    uint32_t x = n0;
+    for (int i = 0; i < 4; ++i)
+        x *= 2u - n0 * x;
+    n0inv_ = uint32_t(0u - x);
+
+    r2_ = BigInt(0).set_bit(64 * words()) % n_;
+}
+
+MontgomeryContext::MontgomeryContext(const BigInt &modulus, uint32_t n0inv, const BigInt &r2)
+    : n_(modulus), n0inv_(n0inv), r2_(r2)
+{
+    n_.normalize();
+    r2_.normalize();
+    n_words_ = n_.data;
+}
+
+void MontgomeryContext::load_words(uint32_t *dst, BigIntView a) const
+{
+    size_t n = words();
+    size_t k = min(n, a.len);
+    if (k)
+        memcpy(dst, a.limbs, k * sizeof(uint32_t));
+    if (k < n)
+        memset(dst + k, 0, (n - k) * sizeof(uint32_t));
+}
+
+void MontgomeryContext::mul_words(uint32_t *r, const uint32_t *a, const uint32_t *b, uint32_t *t) const
+{
+    const size_t n = words();
+    const uint32_t *N = n_words_.data();
+    memset(t, 0, (n + 2) * sizeof(uint32_t));
+    for (size_t i = 0; i < n; ++i)
+    {
+        // t += a * b[i]
+        uint64_t bi = b[i];
+        uint64_t C = 0;
+        for (size_t j = 0; j < n; ++j)
+        {
+            uint64_t s = uint64_t(t[j]) + uint64_t(a[j]) * bi + C;
+            t[j] = uint32_t(s);
+            C = s >> 32;
+        }
+        uint64_t s = uint64_t(t[n]) + C;
+        t[n] = uint32_t(s);
+        t[n + 1] = uint32_t(s >> 32);
+
+        // t = (t + m*N) / 2^32, với m chọn để word thấp bằng 0
+        uint32_t m = t[0] * n0inv_;
+        s = uint64_t(t[0]) + uint64_t(m) * N[0];
+        C = s >> 32;
+        for (size_t j = 1; j < n; ++j)
+        {
+            s = uint64_t(t[j]) + uint64_t(m) * N[j] + C;
+            t[j - 1] = uint32_t(s);
+            C = s >> 32;
+        }
+        s = uint64_t(t[n]) + C;
+        t[n - 1] = uint32_t(s);
+        t[n] = t[n + 1] + uint32_t(s >> 32);
+    }
+
+    // t < 2N; trừ N một lần nếu cần
+    bool ge = t[n] != 0;
+    if (!ge)
+    {
+        ge = true; // bằng nhau cũng trừ
+        for (size_t i = n; i-- > 0;)
+        {
+            if (t[i] != N[i])
+            {
+                ge = t[i] > N[i];
+                break;
+            }
+        }
+    }
+    if (ge)
+    {
+        int64_t borrow = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            int64_t d = int64_t(t[i]) - int64_t(N[i]) - borrow;
+            r[i] = uint32_t(uint64_t(d));
+            borrow = d < 0 ? 1 : 0;
+        }
+    }
+    else
+    {
+        memcpy(r, t, n * sizeof(uint32_t));
+    }
+}
+
+BigInt MontgomeryContext::to_mont(BigIntView a) const
+{
+    size_t n = words();
+    vector<uint32_t> buf(3 * n + 2);
+    uint32_t *x = buf.data(), *r2 = x + n, *t = r2 + n;
+    if (compare(a, n_) < 0)
+        load_words(x, a); // trường hợp thường gặp: đọc thẳng, không sao chép
+    else
+    {
+        BigInt q, r;
+        divmod(a, n_, q, r);
+        load_words(x, r);
+    }
+    load_words(r2, r2_);
+    mul_words(x, x, r2, t);
+    return from_words(x, n);
+}
+
+BigInt MontgomeryContext::from_mont(BigIntView a) const
+{
+    size_t n = words();
+    vector<uint32_t> buf(3 * n + 2, 0u);
+    uint32_t *x = buf.data(), *one = x + n, *t = one + n;
+    load_words(x, a);
+    one[0] = 1u;
+    mul_words(x, x, one, t);
+    return from_words(x, n);
+}
+
+BigInt MontgomeryContext::mul(BigIntView a, BigIntView b) const
+{
+    size_t n = words();
+    vector<uint32_t> buf(3 * n + 2);
+    uint32_t *x = buf.data(), *y = x + n, *t = y + n;
+    load_words(x, a);
+    load_words(y, b);
+    mul_words(x, x, y, t);
+    return from_words(x, n);
+}
+
+BigInt MontgomeryContext::pow(BigIntView base, BigIntView exp) const
+{
+    const size_t n = words();
+    int eb = int(exp.bit_length());
+    if (eb == 0)
+        return BigInt(1);
+
+    // table[k] = base^k (dạng Montgomery), k = 0..15; cửa sổ cố định 4 bit từ trên xuống
+    vector<uint32_t> buf(18 * n + 2);
+    uint32_t *table = buf.data();
+    uint32_t *acc = table + 16 * n;
+    uint32_t *t = acc + n;
+    load_words(table, to_mont(BigInt(1)));
+    load_words(table + n, to_mont(base));
+    for (int k = 2; k < 16; ++k)
+        mul_words(table + k * n, table + (k - 1) * n, table + n, t);
+
+    int windows = (eb + 3) / 4;
+    memcpy(acc, table + get_bits(exp, 4 * (windows - 1), 4) * n, n * sizeof(uint32_t));
+    for (int w = windows - 2; w >= 0; --w)
+    {
+        for (int k = 0; k < 4; ++k)
+            mul_words(acc, acc, acc, t);
+        uint32_t d = get_bits(exp, 4 * w, 4);
+        if (d)
+            mul_words(acc, acc, table + d * n, t);
+    }
+    return from_mont(from_words(acc, n));
+}
+
+FixedBaseTable build_fixed_base_table(const MontgomeryContext &ctx, const BigInt &g, int exp_bits, int window)
+{
+    if (window < 1 || window > 8)
+        throw runtime_error("build_fixed_base_table: window must be in [1, 8]");
+    FixedBaseTable table;
+    table.window = window;
+    table.exp_bits = exp_bits;
+    table.words = ctx.words();
+    const size_t n = ctx.words();
+    const size_t per = (size_t(1) << window) - 1;
+    const size_t rows = size_t((exp_bits + window - 1) / window);
+    table.limbs.assign(rows * per * n, 0u);
+
+    vector<uint32_t> scratch(2 * n + 2);
+    uint32_t *base = scratch.data(), *t = base + n;
+    ctx.load_words(base, ctx.to_mont(g));
+    for (size_t i = 0; i < rows; ++i)
+    {
+        uint32_t *row = table.limbs.data() + i * per * n;
+        // row[j-1] = base^j
+        memcpy(row, base, n * sizeof(uint32_t));
+        for (size_t j = 2; j <= per; ++j)
+            ctx.mul_words(row + (j - 1) * n, row + (j - 2) * n, base, t);
+        // base = base^(2^window)
+        for (int k = 0; k < window; ++k)
+            ctx.mul_words(base, base, base, t);
+    }
+    return table;
+}
+
+BigInt fixed_base_pow(const MontgomeryContext &ctx, const uint32_t *table_limbs, int window, int exp_bits,
+                      const BigInt &g, BigIntView exp)
+{
+    int eb = int(exp.bit_length());
+    if (eb == 0)
+        return BigInt(1);
+    if (eb > exp_bits || table_limbs == nullptr)
+        return ctx.pow(g, exp);
+
+    const size_t n = ctx.words();
+    const size_t per = (size_t(1) << window) - 1;
+    vector<uint32_t> scratch(2 * n + 2);
+    uint32_t *acc = scratch.data(), *t = acc + n;
+    bool have = false;
+    int rows = (eb + window - 1) / window;
+    for (int i = 0; i < rows; ++i)
+    {
+        uint32_t d = get_bits(exp, i * window, window);
+        if (d == 0)
+            continue;
+        const uint32_t *entry = table_limbs + (size_t(i) * per + (d - 1)) * n;
+        if (!have)
+        {
+            memcpy(acc, entry, n * sizeof(uint32_t));
+            have = true;
+        }
+        else
+        {
+            ctx.mul_words(acc, acc, entry, t);
+        }
+    }
+    return ctx.from_mont(from_words(acc, n));
+}
+
+BigInt fixed_base_pow(const MontgomeryContext &ctx, const FixedBaseTable &table, const BigInt &g, BigIntView exp)
+{
+    return fixed_base_pow(ctx, table.empty() ? nullptr : table.limbs.data(), table.window, table.exp_bits, g, exp);
+}
@@ -0,0 +1,68 @@
+// Montgomery.h
+// Nhân Montgomery (CIOS, word 32-bit) cho modulus lẻ và bảng lũy thừa cơ sở cố định.
+// Giá trị ở dạng Montgomery là a*R mod n với R = 2^(32*words); bên trong lưu đúng
+// `words` word (không normalize) để các vòng lặp không phải cấp phát lại.
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "BigInt.h"
+
+class MontgomeryContext
+{
+public:
+    MontgomeryContext() = default;
+    // Tính n0inv = -n^-1 mod 2^32 và R^2 mod n; modulus phải lẻ và > 1
+    explicit MontgomeryContext(const BigInt &modulus);
+    // Dựng lại từ hằng số đã tính sẵn (ví dụ đọc từ DHGroupStore), không kiểm tra lại
+    MontgomeryContext(const BigInt &modulus, uint32_t n0inv, const BigInt &r2);
+
+    const BigInt &modulus() const { return n_; }
+    uint32_t n0inv() const { return n0inv_; }
+    const BigInt &r2() const { return r2_; }
+    size_t words() const { return n_words_.size(); }
+
+    // Chuyển đổi giữa dạng thường và dạng Montgomery (kết quả đã normalize).
+    // Đầu vào là view nên đọc được thẳng từ buffer ngoài.
+    BigInt to_mont(BigIntView a) const;
+    BigInt from_mont(BigIntView a) const;
+    // Tích Montgomery a*b*R^-1 mod n; a, b ở dạng Montgomery
+    BigInt mul(BigIntView a, BigIntView b) const;
+    // base^exp mod n, vào/ra ở dạng thường; cửa sổ cố định 4 bit
+    BigInt pow(BigIntView base, BigIntView exp) const;
+
+    // Nhân thô trên buffer `words()` word: r = a*b*R^-1 mod n.
+    // scratch cần ít nhất words()+2 word; r có thể trùng a hoặc b.
+    void mul_words(uint32_t *r, const uint32_t *a, const uint32_t *b, uint32_t *scratch) const;
+    // Chép a (đã < n) vào buffer words() word, thêm 0 ở đầu
+    void load_words(uint32_t *dst, BigIntView a) const;
+
+private:
+    BigInt n_;
+    std::vector<uint32_t> n_words_; // n với đúng words() word
+    uint32_t n0inv_ = 0;
+    BigInt r2_;
+};
+
+// Bảng lũy thừa của một cơ sở cố định g: entry (i, j) = g^(j * 2^(window*i)) ở dạng
+// Montgomery, j = 1..2^window-1, i = 0..ceil(exp_bits/window)-1. Khi đó g^e chỉ cần
+// khoảng exp_bits/window phép nhân và không có phép bình phương nào.
+struct FixedBaseTable
+{
+    int window = 0;
+    int exp_bits = 0;
+    size_t words = 0;             // số word mỗi entry (= MontgomeryContext::words())
+    std::vector<uint32_t> limbs;  // các entry liên tiếp, mỗi entry `words` word
+
+    bool empty() const { return limbs.empty(); }
+    size_t entry_count() const { return words ? limbs.size() / words : 0; }
+    size_t memory_bytes() const { return limbs.size() * sizeof(uint32_t); }
+};
+
+FixedBaseTable build_fixed_base_table(const MontgomeryContext &ctx, const BigInt &g, int exp_bits, int window);
+
+// g^exp mod n dùng bảng; nếu exp dài hơn bảng thì quay về ctx.pow
+BigInt fixed_base_pow(const MontgomeryContext &ctx, const FixedBaseTable &table, const BigInt &g, BigIntView exp);
+// Như trên nhưng đọc bảng từ buffer ngoài (ví dụ vùng mmap), không sao chép
+BigInt fixed_base_pow(const MontgomeryContext &ctx, const uint32_t *table_limbs, int window, int exp_bits,
+                      const BigInt &g, BigIntView exp);
@@ -0,0 +1,301 @@
+// NumberTheory.cpp
+#include "NumberTheory.h"
+#include <stdexcept>
+#include <utility>
+#include "Montgomery.h"
+
+using namespace std;
+
+// ===== Phép toán tại chỗ trên BigInt đã normalize =====
+
+static inline bool is_zero(const BigInt &a)
+{
+    return a.data.size() == 1 && a.data[0] == 0;
+}
+
+static inline bool is_one(const BigInt &a)
+{
+    return a.data.size() == 1 && a.data[0] == 1;
+}
+
+static inline bool is_odd(const BigInt &a)
+{
+    return (a.data[0] & 1u) != 0;
+}
+
+// a -= b, yêu cầu a >= b
+static void sub_inplace(BigInt &a, const BigInt &b)
+{
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < b.data.size(); ++i)
+    {
+        uint64_t d = uint64_t(a.data[i]) - b.data[i] - borrow;
+        a.data[i] = uint32_t(d);
+        borrow = (d >> 63) & 1u;
+    }
+    for (; borrow && i < a.data.size(); ++i)
+    {
+        borrow = a.data[i] == 0;
+        a.data[i] -= 1u;
+    }
+    a.normalize();
+}
+
+// a += b
+static void add_inplace(BigInt &a, const BigInt &b)
+{
+    if (a.data.size() < b.data.size())
+        a.data.resize(b.data.size(), 0u);
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < b.data.size(); ++i)
+    {
+        uint64_t s = uint64_t(a.data[i]) + b.data[i] + carry;
+        a.data[i] = uint32_t(s);
+        carry = s >> 32;
+    }
+    for (; carry && i < a.data.size(); ++i)
+    {
+        a.data[i] += 1u;
+        carry = a.data[i] == 0;
+    }
+    if (carry)
+        a.data.push_back(1u);
+}
+
+// x = (x - y) mod m với 0 <= x, y < m
+static void sub_mod_inplace(BigInt &x, const BigInt &y, const BigInt &m)
+{
+    if (compare(x, y) < 0)
+        add_inplace(x, m);
+    sub_inplace(x, y);
+}
+
+// x = x / 2 mod m với m lẻ
+static void half_mod_inplace(BigInt &x, const BigInt &m)
+{
+    if (is_odd(x))
+        add_inplace(x, m);
+    x.shr_bits_inplace(1);
+}
+
+// ===== GCD =====
+
+void gcd_inplace(BigInt &a, const BigInt &b_in)
+{
+    a.normalize();
+    BigInt b = b_in;
+    b.normalize();
+    if (is_zero(a))
+    {
+        a = b;
+        return;
+    }
+    if (is_zero(b))
+        return;
+
+    // Stein: gcd(a, b) = 2^k * gcd(a', b') với a', b' lẻ; sau đó trừ số nhỏ khỏi số lớn
+    int za = int(a.count_trailing_zeros()), zb = int(b.count_trailing_zeros());
+    int k = za < zb ? za : zb;
+    a.shr_bits_inplace(za);
+    b.shr_bits_inplace(zb);
+    for (;;)
+    {
+        // a, b lẻ
+        int c = compare(a, b);
+        if (c == 0)
+            break;
+        if (c > 0)
+            swap(a, b);
+        sub_inplace(b, a); // b chẵn, khác 0
+        b.shr_bits_inplace(int(b.count_trailing_zeros()));
+    }
+    if (k)
+        a = a.shl_bits(k);
+}
+
+BigInt gcd(const BigInt &a, const BigInt &b)
+{
+    BigInt r = a;
+    gcd_inplace(r, b);
+    return r;
+}
+
+// ===== Nghịch đảo modulo =====
+
+// m lẻ > 1: Euclid nhị phân mở rộng, bất biến x1*a = u, x2*a = v (mod m)
+static bool mod_inverse_odd(BigInt &a, const BigInt &m)
+{
+    BigInt u = compare(a, m) < 0 ? a : a % m;
+    u.normalize();
+    if (is_zero(u))
+        return false;
+    BigInt v = m;
+    BigInt x1(1), x2(0);
+    while (!is_one(u) && !is_one(v))
+    {
+        while (!is_odd(u))
+        {
+            u.shr_bits_inplace(1);
+            half_mod_inplace(x1, m);
+        }
+        while (!is_odd(v))
+        {
+            v.shr_bits_inplace(1);
+            half_mod_inplace(x2, m);
+        }
+        if (compare(u, v) >= 0)
+        {
+            sub_inplace(u, v);
+            sub_mod_inplace(x1, x2, m);
+            if (is_zero(u))
+                return false; // u = v > 1: gcd(a, m) = v
+        }
+        else
+        {
+            sub_inplace(v, u);
+            sub_mod_inplace(x2, x1, m);
+        }
+    }
+    a = is_one(u) ? x1 : x2;
+    return true;
+}
+
+// m chẵn: Euclid mở rộng với divmod, hệ số giữ trong [0, m)
+static bool mod_inverse_euclid(BigInt &a, const BigInt &m)
+{
+    BigInt r0 = m, r1 = a % m;
+    r1.normalize();
+    BigInt t0(0), t1(1);
+    BigInt q, r;
+    while (!is_zero(r1))
+    {
+        r0.divmod(r1, q, r);
+        r.normalize();
+        BigInt qt = (q * t1) % m;
+        qt.normalize();
+        BigInt t2 = t0;
+        sub_mod_inplace(t2, qt, m);
+        r0 = std::move(r1);
+        r1 = std::move(r);
+        t0 = std::move(t1);
+        t1 = std::move(t2);
+    }
+    if (!is_one(r0))
+        return false;
+    a = t0;
+    return true;
+}
+
+bool mod_inverse_inplace(BigInt &a, const BigInt &m_in)
+{
+    BigInt m = m_in;
+    m.normalize();
+    a.normalize();
+    if (compare(m, 1u) <= 0)
+        return false;
+    return is_odd(m) ? mod_inverse_odd(a, m) : mod_inverse_euclid(a, m);
+}
+
+BigInt mod_inverse(const BigInt &a, const BigInt &m)
+{
+    if (compare(m, 1u) <= 0)
+        throw runtime_error("mod_inverse: modulus must be > 1");
+    BigInt r = a;
+    if (!mod_inverse_inplace(r, m))
+        throw runtime_error("mod_inverse: value is not invertible");
+    return r;
+}
+
+// ===== Ký hiệu Jacobi =====
+
+int jacobi(BigIntView a_in, const BigInt &n_in)
+{
+    BigInt n = n_in;
+    n.normalize();
+    if (is_zero(n) || !is_odd(n))
+        throw runtime_error("jacobi: n must be odd and positive");
+    // bản sao làm việc duy nhất của a (thuật toán sửa tại chỗ)
+    BigInt a;
+    if (compare(a_in, n) < 0)
+        a = BigInt(a_in);
+    else
+    {
+        BigInt q;
+        divmod(a_in, n, q, a);
+    }
+    int t = 1;
+    // Bản nhị phân: bỏ thừa số 2 (luật bổ sung thứ hai), đổi chỗ theo luật thuận nghịch
+    // bậc hai khi a < n, rồi trừ n; không cần phép chia nào.
+    while (!is_zero(a))
+    {
+        int s = int(a.count_trailing_zeros());
+        a.shr_bits_inplace(s);
+        uint32_t n8 = n.data[0] & 7u;
+        if ((s & 1) && (n8 == 3 || n8 == 5))
+            t = -t;
+        if (compare(a, n) < 0)
+        {
+            swap(a, n);
+            if ((a.data[0] & 3u) == 3 && (n.data[0] & 3u) == 3)
+                t = -t;
+        }
+        sub_inplace(a, n);
+    }
+    return is_one(n) ? t : 0;
+}
+
+// ===== Nghịch đảo hàng loạt =====
+
+bool batch_mod_inverse(vector<BigInt> &values, const BigInt &m_in)
+{
+    BigInt m = m_in;
+    m.normalize();
+    if (compare(m, 1u) <= 0)
+        return false;
+    const size_t n = values.size();
+    if (n == 0)
+        return true;
+
+    if (is_odd(m))
+    {
+        // Nhân Montgomery thẳng trên giá trị thường, không to_mont/from_mont: mỗi tích thêm
+        // một R^-1. prefix[i] = a_0 ... a_i * R^-i; nghịch đảo thường của prefix[n-1] là
+        // (a_0 ... a_{n-1})^-1 * R^(n-1), và khi đi ngược, inv giữ (a_0 ... a_i)^-1 * R^i nên
+        // mul(inv, prefix[i-1]) = a_i^-1 với số mũ của R triệt tiêu đúng bằng 0.
+        MontgomeryContext ctx(m);
+        vector<BigInt> a(n), prefix(n);
+        for (size_t i = 0; i < n; ++i)
+            a[i] = compare(values[i], m) < 0 ? values[i] : values[i] % m;
+        prefix[0] = a[0];
+        for (size_t i = 1; i < n; ++i)
+            prefix[i] = ctx.mul(prefix[i - 1], a[i]);
+        BigInt inv = prefix[n - 1];
+        if (!mod_inverse_odd(inv, m))
+            return false;
+        for (size_t i = n - 1; i > 0; --i)
+        {
+            values[i] = ctx.mul(inv, prefix[i - 1]);
+            inv = ctx.mul(inv, a[i]);
+        }
+        values[0] = std::move(inv);
+        return true;
+    }
+
+    vector<BigInt> prefix(n);
+    prefix[0] = values[0] % m;
+    for (size_t i = 1; i < n; ++i)
+        prefix[i] = (prefix[i - 1] * values[i]) % m;
+    BigInt inv = prefix[n - 1];
+    if (!mod_inverse_euclid(inv, m))
+        return false;
+    for (size_t i = n - 1; i > 0; --i)
+    {
+        BigInt vi = values[i] % m;
+        values[i] = (inv * prefix[i - 1]) % m;
+        inv = (inv * vi) % m;
+    }
+    values[0] = inv;
+    return true;
+}
@@ -0,0 +1,28 @@
+// NumberTheory.h
+// GCD, nghịch đảo modulo và ký hiệu Jacobi trên BigInt. Các hàm làm việc trực tiếp trên
+// BigInt::data bằng dịch bit và trừ tại chỗ (thuật toán nhị phân), không gọi divmod
+// trong vòng lặp, nên chi phí O(n^2) phép word với n = số word.
+#pragma once
+#include <vector>
+#include "BigInt.h"
+
+// gcd(a, b); gcd(0, 0) = 0
+BigInt gcd(const BigInt &a, const BigInt &b);
+// a = gcd(a, b)
+void gcd_inplace(BigInt &a, const BigInt &b);
+
+// x với a*x = 1 (mod m), 0 <= x < m. Ném runtime_error nếu m <= 1 hoặc gcd(a, m) != 1.
+// m lẻ dùng thuật toán nhị phân; m chẵn dùng Euclid mở rộng.
+BigInt mod_inverse(const BigInt &a, const BigInt &m);
+// a = a^-1 mod m; trả về false (a giữ nguyên) nếu không khả nghịch
+bool mod_inverse_inplace(BigInt &a, const BigInt &m);
+
+// Ký hiệu Jacobi (a/n) thuộc {-1, 0, 1}; n phải lẻ và > 0 (ngược lại ném runtime_error).
+// Với n nguyên tố đây là ký hiệu Legendre: 1 nếu a là thặng dư bậc hai khác 0 mod n.
+int jacobi(BigIntView a, const BigInt &n);
+
+// Nghịch đảo mọi phần tử của values mod m tại chỗ bằng mẹo của Montgomery: một lần
+// mod_inverse cộng 3(n-1) phép nhân modulo (m lẻ: nhân Montgomery trên giá trị thường,
+// không chuyển vào/ra miền Montgomery; phần tử >= m tốn thêm một phép chia). Trả về false
+// và giữ nguyên values nếu có phần tử không khả nghịch.
+bool batch_mod_inverse(std::vector<BigInt> &values, const BigInt &m);
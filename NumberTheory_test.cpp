@@ -0,0 +1,191 @@
+// NumberTheory_test.cpp
+// Tests for gcd, mod_inverse, jacobi and batch_mod_inverse
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "BigInt.h"
+#include "NumberTheory.h"
+#include "RemainderTree.h"
+
+using namespace std;
+
+static void expect_true(bool cond, const char *msg)
+{
+    if (!cond)
+    {
+        cerr << "FAIL: " << msg << "\n";
+        exit(1);
+    }
+    else
+        cout << "ok: " << msg << "\n";
+}
+
+static uint64_t gcd64(uint64_t a, uint64_t b)
+{
+    while (b)
+    {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Ký hiệu Jacobi tham chiếu cho số nhỏ (thuật toán chia thông thường)
+static int jacobi64(uint64_t a, uint64_t n)
+{
+    int t = 1;
+    a %= n;
+    while (a)
+    {
+        while ((a & 1) == 0)
+        {
+            a >>= 1;
+            if ((n & 7) == 3 || (n & 7) == 5)
+                t = -t;
+        }
+        uint64_t tmp = a;
+        a = n;
+        n = tmp;
+        if ((a & 3) == 3 && (n & 3) == 3)
+            t = -t;
+        a %= n;
+    }
+    return n == 1 ? t : 0;
+}
+
+static BigInt big(uint64_t v)
+{
+    return BigInt(uint32_t(v >> 32)).shl_bits(32) + BigInt(uint32_t(v));
+}
+
+int main()
+{
+    // 1) small values against 64-bit references
+    {
+        bool g_ok = true, inv_ok = true, j_ok = true;
+        for (uint64_t a = 0; a < 60; ++a)
+        {
+            for (uint64_t m = 1; m < 60; ++m)
+            {
+                g_ok = g_ok && gcd(big(a), big(m)) == big(gcd64(a, m));
+                if (m > 1)
+                {
+                    BigInt x = big(a);
+                    bool ok = mod_inverse_inplace(x, big(m));
+                    bool expect = gcd64(a, m) == 1;
+                    inv_ok = inv_ok && ok == expect;
+                    if (ok)
+                        inv_ok = inv_ok && x < big(m) && (x * big(a)) % big(m) == BigInt(1);
+                }
+                if (m & 1)
+                    j_ok = j_ok && jacobi(big(a), big(m)) == jacobi64(a, m);
+            }
+        }
+        expect_true(g_ok, "gcd matches Euclid for a, m < 60");
+        expect_true(inv_ok, "mod_inverse matches gcd == 1 for odd and even moduli");
+        expect_true(j_ok, "jacobi matches reference for odd n < 60");
+    }
+
+    // 2) multi-word values
+    {
+        BigInt p("170141183460469231731687303715884105727"); // 2^127 - 1
+        BigInt a("123456789012345678901234567890123456789");
+        BigInt x = mod_inverse(a, p);
+        expect_true((a * x) % p == BigInt(1), "inverse modulo 2^127 - 1");
+        BigInt m = BigInt(1).shl_bits(200); // modulus chẵn
+        BigInt y = mod_inverse(a, m);
+        expect_true((a * y) % m == BigInt(1), "inverse modulo 2^200");
+        BigInt f = BigInt("1000000007") * BigInt("998244353");
+        expect_true(gcd(f * BigInt("12345"), f * BigInt("67890")) == f * BigInt("15"), "gcd of multi-word values");
+        expect_true(gcd(BigInt(0), a) == a && gcd(a, BigInt(0)) == a, "gcd with zero");
+        // 3 là thặng dư bậc hai mod p khi p = ±1 (mod 12); 2^127 - 1 = 7 (mod 12)
+        expect_true(jacobi(BigInt(3), p) == -1 && jacobi(BigInt(2), p) == 1, "Legendre symbols mod 2^127 - 1");
+        expect_true(jacobi(a * a, p) == 1, "square is a residue");
+        bool threw = false;
+        try
+        {
+            mod_inverse(BigInt(6), BigInt(9));
+        }
+        catch (const runtime_error &)
+        {
+            threw = true;
+        }
+        expect_true(threw, "non-invertible value throws");
+    }
+
+    // 3) batch inversion agrees with one-by-one inversion
+    {
+        BigInt p("170141183460469231731687303715884105727");
+        vector<BigInt> vals, expect;
+        BigInt v("987654321987654321");
+        for (int i = 0; i < 20; ++i)
+        {
+            v = (v * v + BigInt(12345)) % p;
+            vals.push_back(v);
+            expect.push_back(mod_inverse(v, p));
+        }
+        vector<BigInt> odd = vals;
+        expect_true(batch_mod_inverse(odd, p) && odd == expect, "batch inversion, odd modulus");
+
+        BigInt m = BigInt(1).shl_bits(130);
+        vector<BigInt> even, expect_even;
+        for (int i = 0; i < 10; ++i)
+        {
+            even.push_back(BigInt(uint32_t(2 * i + 3)) * vals[i]);
+            if (!(even.back().data[0] & 1u))
+                even.back() = even.back() + BigInt(1);
+            expect_even.push_back(mod_inverse(even.back(), m));
+        }
+        expect_true(batch_mod_inverse(even, m) && even == expect_even, "batch inversion, even modulus");
+
+        vector<BigInt> big = {vals[0] + p * BigInt(3), vals[1]}, one = {vals[2] + p};
+        expect_true(batch_mod_inverse(big, p) && big[0] == expect[0] && big[1] == expect[1] &&
+                        batch_mod_inverse(one, p) && one[0] == expect[2],
+                    "batch inversion reduces inputs >= m, single element");
+
+        vector<BigInt> bad = {BigInt(3), BigInt(0), BigInt(5)};
+        expect_true(!batch_mod_inverse(bad, p) && bad[1] == BigInt(0) && bad[0] == BigInt(3),
+                    "batch inversion rejects zero and leaves input untouched");
+    }
+
+    // 4) remainder tree agrees with one division per modulus
+    {
+        vector<uint32_t> moduli;
+        for (uint32_t m = 3; moduli.size() < 300; m += 2)
+            moduli.push_back(m);
+        moduli.push_back(4294967291u); // số nguyên tố lớn nhất dưới 2^32: một lá riêng
+        moduli.push_back(2u);
+        RemainderTree tree(moduli);
+        BigInt prod(1);
+        for (uint32_t m : moduli)
+            prod = prod * BigInt(m);
+        expect_true(tree.product() == prod, "product tree root");
+
+        vector<BigInt> ns = {BigInt(0), BigInt(12345), prod - BigInt(1), prod * prod + BigInt(7),
+                             BigInt("340282366920938463463374607431768211457")};
+        vector<uint32_t> out;
+        tree.residues(ns, out);
+        bool ok = out.size() == ns.size() * moduli.size();
+        for (size_t j = 0; ok && j < ns.size(); ++j)
+            for (size_t i = 0; i < moduli.size(); ++i)
+                ok = ok && out[j * moduli.size() + i] == (ns[j] % BigInt(moduli[i])).data[0];
+        expect_true(ok, "residues match operator% for every modulus");
+        bool threw = false;
+        try
+        {
+            RemainderTree bad(vector<uint32_t>{3, 1});
+        }
+        catch (const runtime_error &)
+        {
+            threw = true;
+        }
+        RemainderTree empty(vector<uint32_t>{});
+        empty.residues(BigInt(5), out);
+        expect_true(threw && out.empty(), "modulus 1 rejected, empty tree");
+    }
+
+    cout << "All number theory tests passed.\n";
+    return 0;
+}
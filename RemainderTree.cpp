@@ -0,0 +1,110 @@
+// RemainderTree.cpp
+#include "RemainderTree.h"
+#include <stdexcept>
+#include <algorithm>
+
+using namespace std;
+
+RemainderTree::RemainderTree(const vector<uint32_t> &moduli) : moduli_(moduli)
+{
+    // Lá: gói các modulus liên tiếp khi tích còn vừa một word
+    vector<BigInt> leaves;
+    uint64_t prod = 1;
+    for (size_t i = 0; i < moduli_.size(); ++i)
+    {
+        uint32_t m = moduli_[i];
+        if (m <= 1)
+            throw runtime_error("RemainderTree: moduli must be > 1");
+        if (i == 0 || prod * m > 0xFFFFFFFFull)
+        {
+            if (i > 0)
+                leaves.push_back(BigInt(uint32_t(prod)));
+            leaf_begin_.push_back(i);
+            prod = 1;
+        }
+        prod *= m;
+    }
+    if (moduli_.empty())
+        return;
+    leaves.push_back(BigInt(uint32_t(prod)));
+    leaf_begin_.push_back(moduli_.size());
+
+    // Các tầng trên: nhân từng cặp, nút lẻ cuối được đưa thẳng lên
+    levels_.push_back(std::move(leaves));
+    while (levels_.back().size() > 1)
+    {
+        const vector<BigInt> &below = levels_.back();
+        vector<BigInt> level;
+        level.reserve((below.size() + 1) / 2);
+        for (size_t i = 0; i < below.size(); i += 2)
+            level.push_back(i + 1 < below.size() ? below[i] * below[i + 1] : below[i]);
+        levels_.push_back(std::move(level));
+    }
+}
+
+const BigInt &RemainderTree::product() const
+{
+    static const BigInt one(1);
+    return levels_.empty() ? one : levels_.back()[0];
+}
+
+// Tầng thấp nhất còn rút gọn bằng divmod: nút ở đó là tích của 2^DIRECT_LEVEL lá, khoảng
+// 8 word. Dưới đó divmod trên số vài word tốn hơn chia thẳng từng word cho mỗi lá.
+static const size_t DIRECT_LEVEL = 3;
+
+void RemainderTree::residues(BigIntView n, vector<uint32_t> &out) const
+{
+    out.resize(moduli_.size());
+    if (moduli_.empty())
+        return;
+
+    size_t stop = min(DIRECT_LEVEL, levels_.size() - 1);
+    // Số dư của mỗi nút là view: trỏ lại số dư của nút cha khi nó đã nhỏ hơn nút (không
+    // chia, không chép), hoặc vào `store` khi phải chia. store được reserve đủ cho mọi nút
+    // nên không cấp phát lại và các view không bị treo.
+    size_t nodes_total = 0;
+    for (size_t L = stop; L < levels_.size(); ++L)
+        nodes_total += levels_[L].size();
+    vector<BigInt> store;
+    store.reserve(nodes_total);
+    vector<BigIntView> rem(1, n), next;
+    BigInt q;
+    for (size_t L = levels_.size(); L-- > stop;)
+    {
+        const vector<BigInt> &nodes = levels_[L];
+        next.resize(nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            BigIntView parent = rem[L + 1 < levels_.size() ? i / 2 : 0];
+            if (compare(parent, nodes[i]) < 0)
+                next[i] = parent;
+            else
+            {
+                store.emplace_back();
+                divmod(parent, nodes[i], q, store.back());
+                next[i] = store.back();
+            }
+        }
+        rem.swap(next);
+    }
+
+    // Lá k nằm dưới nút k >> stop; số dư của lá < 2^32, tách ra từng modulus trong lá
+    const vector<BigInt> &leaves = levels_[0];
+    for (size_t k = 0; k < leaves.size(); ++k)
+    {
+        uint32_t r = mod_word(rem[k >> stop], leaves[k].data[0]);
+        for (size_t i = leaf_begin_[k]; i < leaf_begin_[k + 1]; ++i)
+            out[i] = r % moduli_[i];
+    }
+}
+
+void RemainderTree::residues(const vector<BigInt> &ns, vector<uint32_t> &out) const
+{
+    out.resize(ns.size() * moduli_.size());
+    vector<uint32_t> one;
+    for (size_t j = 0; j < ns.size(); ++j)
+    {
+        residues(ns[j], one);
+        copy(one.begin(), one.end(), out.begin() + j * moduli_.size());
+    }
+}
@@ -0,0 +1,35 @@
+// RemainderTree.h
+// Cây phần dư: số dư của một (hoặc nhiều) BigInt theo cả một dãy modulus một word.
+// Dựng một lần cây tích của các modulus (lá là tích của vài modulus liên tiếp gói vừa
+// một word), rồi rút gọn từ gốc xuống: n mod (tích của cả nút) rồi mod từng nút con. Mỗi
+// tầng chỉ chia các số dài bằng nút của tầng đó, nên chi phí cả cây xấp xỉ chi phí nhân
+// tích tất cả modulus một lần, thay vì |moduli| lần chia cả n cho từng word. Với phép nhân
+// nhanh (comba, Karatsuba) tổng chi phí là tựa tuyến tính.
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "BigInt.h"
+
+class RemainderTree
+{
+public:
+    RemainderTree() = default;
+    // moduli: các số > 1 (thường là số nguyên tố nhỏ); ném runtime_error nếu có số <= 1
+    explicit RemainderTree(const std::vector<uint32_t> &moduli);
+
+    const std::vector<uint32_t> &moduli() const { return moduli_; }
+    size_t size() const { return moduli_.size(); }
+    // Tích của mọi modulus (gốc của cây)
+    const BigInt &product() const;
+
+    // out[i] = n mod moduli()[i]
+    void residues(BigIntView n, std::vector<uint32_t> &out) const;
+    // Nhiều số dùng chung cây: out[j * size() + i] = ns[j] mod moduli()[i]
+    void residues(const std::vector<BigInt> &ns, std::vector<uint32_t> &out) const;
+
+private:
+    std::vector<uint32_t> moduli_;
+    std::vector<size_t> leaf_begin_;         // lá k gồm moduli_[leaf_begin_[k] .. leaf_begin_[k+1])
+    std::vector<std::vector<BigInt>> levels_; // levels_[0]: các lá; levels_.back(): gốc
+};
@@ -0,0 +1,189 @@
+// SafePrimePool.cpp
+#include "SafePrimePool.h"
+#include <stdexcept>
+#include <string>
+#include "DiffieHellman.h"
+#include "ChaCha20.h"
+
+using namespace std;
+
+static bool random_start_generator(int bits, const atomic<bool> &cancel, BigInt &out)
+{
+    return generate_safe_prime_random(bits, ChaCha20Rng::thread_local_instance(), &cancel, out);
+}
+
+// Thời gian worker nghỉ sau khi generator ném ngoại lệ, để generator luôn lỗi không chiếm trọn CPU
+static const chrono::milliseconds FAILURE_BACKOFF(100);
+
+SafePrimePool::SafePrimePool(const vector<int> &bit_sizes, size_t target, size_t threads, Generator generator)
+    : generator_(generator ? std::move(generator) : Generator(random_start_generator)),
+      target_(target == 0 ? 1 : target),
+      started_(chrono::steady_clock::now())
+{
+    for (int bits : bit_sizes)
+    {
+        if (find_slot(bits))
+            continue;
+        slots_.push_back(unique_ptr<Slot>(new Slot(bits, target_)));
+    }
+    if (threads == 0)
+        threads = thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+        workers_.emplace_back([this]
+                              { worker_loop(); });
+}
+
+SafePrimePool::~SafePrimePool()
+{
+    {
+        lock_guard<mutex> lk(mu_);
+        stopping_.store(true);
+    }
+    cv_.notify_all();
+    for (auto &t : workers_)
+        t.join();
+}
+
+SafePrimePool::Slot *SafePrimePool::find_slot(int bits) const
+{
+    for (const auto &s : slots_)
+        if (s->bits == bits)
+            return s.get();
+    return nullptr;
+}
+
+// Chọn hàng đợi thiếu nhiều nhất (tính cả phần đang sinh) và giữ chỗ cho một lần sinh
+SafePrimePool::Slot *SafePrimePool::reserve_work()
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    for (;;)
+    {
+        Slot *best = nullptr;
+        size_t best_have = target_;
+        for (const auto &s : slots_)
+        {
+            size_t have = s->queue.size() + s->in_flight.load();
+            if (have < best_have)
+            {
+                best = s.get();
+                best_have = have;
+            }
+        }
+        if (!best)
+            return nullptr;
+        size_t prev = best->in_flight.fetch_add(1);
+        if (best->queue.size() + prev < target_)
+            return best;
+        // worker khác vừa giữ chỗ cuối cùng; trả lại và chọn lại
+        best->in_flight.fetch_sub(1);
+    }
+}
+
+void SafePrimePool::worker_loop()
+{
+    while (!stopping_.load())
+    {
+        Slot *slot = reserve_work();
+        if (!slot)
+        {
+            unique_lock<mutex> lk(mu_);
+            sleeping_.fetch_add(1);
+            Slot *found = nullptr;
+            cv_.wait(lk, [&]
+                     { return stopping_.load() || (found = reserve_work()) != nullptr; });
+            sleeping_.fetch_sub(1);
+            slot = found;
+            if (!slot)
+                continue;
+        }
+
+        auto t0 = chrono::steady_clock::now();
+        BigInt p;
+        bool ok = false, failed = false;
+        try
+        {
+            ok = generator_(slot->bits, stopping_, p);
+        }
+        catch (...)
+        {
+            failed = true;
+        }
+        if (ok)
+        {
+            auto t1 = chrono::steady_clock::now();
+            slot->gen_nanos.fetch_add(uint64_t(chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count()),
+                                      memory_order_relaxed);
+            slot->generated.fetch_add(1, memory_order_relaxed);
+            slot->queue.try_push(std::move(p)); // chỉ thất bại khi kho đã đầy, bỏ số thừa
+        }
+        slot->in_flight.fetch_sub(1);
+        if (failed)
+        {
+            slot->failed.fetch_add(1, memory_order_relaxed);
+            unique_lock<mutex> lk(mu_);
+            cv_.wait_for(lk, FAILURE_BACKOFF, [&]
+                         { return stopping_.load(); });
+        }
+    }
+}
+
+void SafePrimePool::wake_workers()
+{
+    // Ghép với fence trong reserve_work: hoặc worker thấy chỗ trống vừa được pop,
+    // hoặc ta thấy sleeping_ > 0 và đánh thức nó
+    atomic_thread_fence(memory_order_seq_cst);
+    if (sleeping_.load() == 0)
+        return;
+    {
+        lock_guard<mutex> lk(mu_);
+    }
+    cv_.notify_one();
+}
+
+bool SafePrimePool::try_pop(int bits, BigInt &out)
+{
+    Slot *slot = find_slot(bits);
+    if (!slot)
+        return false;
+    if (!slot->queue.try_pop(out))
+    {
+        slot->misses.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    slot->popped.fetch_add(1, memory_order_relaxed);
+    wake_workers();
+    return true;
+}
+
+BigInt SafePrimePool::pop(int bits)
+{
+    if (!find_slot(bits))
+        throw runtime_error("SafePrimePool: bit size " + to_string(bits) + " is not served by this pool");
+    BigInt p;
+    if (try_pop(bits, p))
+        return p;
+    // sinh đồng bộ cho người gọi: không bị hủy theo pool
+    const atomic<bool> never{false};
+    generator_(bits, never, p);
+    return p;
+}
+
+vector<SafePrimePool::Stats> SafePrimePool::stats() const
+{
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - started_).count();
+    vector<Stats> out;
+    for (const auto &s : slots_)
+    {
+        uint64_t generated = s->generated.load(memory_order_relaxed);
+        uint64_t nanos = s->gen_nanos.load(memory_order_relaxed);
+        out.push_back({s->bits, target_, s->queue.size(), s->in_flight.load(), generated,
+                       s->popped.load(memory_order_relaxed), s->misses.load(memory_order_relaxed),
+                       s->failed.load(memory_order_relaxed),
+                       generated ? double(nanos) * 1e-9 / double(generated) : 0.0,
+                       elapsed > 0 ? double(generated) / elapsed : 0.0});
+    }
+    return out;
+}
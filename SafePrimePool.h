@@ -0,0 +1,89 @@
+// SafePrimePool.h
+// Sinh số nguyên tố an toàn ở nền: mỗi kích thước bit có một BoundedQueue số đã sinh sẵn,
+// các worker thread luôn bù cho đầy tới `target` phần tử; bên tiêu thụ lấy ra O(1) không
+// khóa nên thời gian tạo nhóm mới trên đường xử lý request là hằng số khi kho còn hàng.
+#pragma once
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include "BigInt.h"
+#include "BoundedQueue.h"
+
+class SafePrimePool
+{
+public:
+    // Hàm sinh một số nguyên tố an toàn với số bit cho trước vào out (mặc định
+    // generate_safe_prime_random, mỗi worker dùng DRBG riêng của thread nên không sinh trùng
+    // vùng tìm kiếm). Phải theo dõi cancel và trả về false sớm khi cờ được bật (pool đang
+    // hủy); ngoại lệ ném ra được worker bắt và đếm vào Stats::failed.
+    using Generator = std::function<bool(int bits, const std::atomic<bool> &cancel, BigInt &out)>;
+
+    struct Stats
+    {
+        int bits;
+        size_t target;      // số phần tử worker cố giữ trong hàng đợi
+        size_t ready;       // số phần tử đang có
+        size_t in_flight;   // số worker đang sinh cho kích thước này
+        uint64_t generated; // tổng số đã sinh
+        uint64_t popped;    // số lần lấy thành công từ hàng đợi
+        uint64_t misses;    // số lần hàng đợi rỗng (pop phải sinh đồng bộ)
+        uint64_t failed;    // số lần generator ném ngoại lệ trên worker
+        double avg_seconds; // thời gian sinh trung bình một số (theo thread)
+        double rate;        // số/giây kể từ khi pool khởi động (toàn bộ worker)
+    };
+
+    // target: số số nguyên tố giữ sẵn cho mỗi kích thước; threads = 0: số core
+    SafePrimePool(const std::vector<int> &bit_sizes, size_t target, size_t threads = 0,
+                  Generator generator = Generator());
+    // Dừng worker: bật cờ hủy cho các lần sinh đang chạy dở rồi chờ chúng trả về
+    ~SafePrimePool();
+
+    SafePrimePool(const SafePrimePool &) = delete;
+    SafePrimePool &operator=(const SafePrimePool &) = delete;
+
+    // Lấy một số đã sinh sẵn; false nếu hàng đợi rỗng hoặc không phục vụ kích thước này
+    bool try_pop(int bits, BigInt &out);
+    // Như try_pop nhưng nếu rỗng thì sinh ngay trên thread gọi.
+    // Ném runtime_error nếu bits không nằm trong danh sách của pool; ngoại lệ của generator
+    // được ném tiếp cho người gọi.
+    BigInt pop(int bits);
+
+    std::vector<Stats> stats() const;
+    size_t thread_count() const { return workers_.size(); }
+
+private:
+    struct Slot
+    {
+        explicit Slot(int b, size_t target) : bits(b), queue(target) {}
+        int bits;
+        BoundedQueue<BigInt> queue;
+        std::atomic<size_t> in_flight{0};
+        std::atomic<uint64_t> generated{0};
+        std::atomic<uint64_t> popped{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> failed{0};
+        std::atomic<uint64_t> gen_nanos{0};
+    };
+
+    Slot *find_slot(int bits) const;
+    Slot *reserve_work();
+    void worker_loop();
+    void wake_workers();
+
+    Generator generator_;
+    size_t target_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::vector<std::thread> workers_;
+    std::chrono::steady_clock::time_point started_;
+
+    // Chỉ dùng để worker ngủ khi mọi hàng đợi đã đầy; đường pop không khóa trừ khi có worker đang ngủ
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::atomic<int> sleeping_{0};
+    std::atomic<bool> stopping_{false};
+};
@@ -0,0 +1,189 @@
+// SafePrimePool_test.cpp
+// Tests for BoundedQueue and the background safe-prime pool
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include "BigInt.h"
+#include "BoundedQueue.h"
+#include "SafePrimePool.h"
+#include "DiffieHellman.h"
+
+using namespace std;
+
+static void expect_true(bool cond, const char *msg)
+{
+    if (!cond)
+    {
+        cerr << "FAIL: " << msg << "\n";
+        exit(1);
+    }
+    else
+        cout << "ok: " << msg << "\n";
+}
+
+// Chờ tối đa 10 giây cho tới khi cond() đúng
+template <class F>
+static bool wait_until(F cond)
+{
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+    while (chrono::steady_clock::now() < deadline)
+    {
+        if (cond())
+            return true;
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    return cond();
+}
+
+int main()
+{
+    // 1) BoundedQueue: FIFO, full/empty, capacity rounding
+    {
+        BoundedQueue<int> q(5);
+        expect_true(q.capacity() == 8, "capacity rounded up to a power of two");
+        bool ok = true;
+        for (int i = 0; i < 8; ++i)
+            ok = ok && q.try_push(i);
+        expect_true(ok && !q.try_push(99) && q.size() == 8, "push until full");
+        int v = -1;
+        for (int i = 0; i < 8; ++i)
+            ok = ok && q.try_pop(v) && v == i;
+        expect_true(ok && !q.try_pop(v) && q.size() == 0, "pop in FIFO order until empty");
+    }
+
+    // 2) BoundedQueue: concurrent producers/consumers see every value exactly once
+    {
+        BoundedQueue<int> q(64);
+        const int producers = 4, per = 20000;
+        atomic<long long> sum{0};
+        atomic<int> count{0};
+        vector<thread> ts;
+        for (int p = 0; p < producers; ++p)
+            ts.emplace_back([&, p]
+                            {
+                                for (int i = 0; i < per; ++i)
+                                    while (!q.try_push(p * per + i))
+                                        this_thread::yield(); });
+        for (int c = 0; c < 3; ++c)
+            ts.emplace_back([&]
+                            {
+                                int v;
+                                while (count.load() < producers * per)
+                                    if (q.try_pop(v))
+                                    {
+                                        sum += v;
+                                        ++count;
+                                    }
+                                    else
+                                        this_thread::yield(); });
+        for (auto &t : ts)
+            t.join();
+        long long n = producers * per;
+        expect_true(count.load() == n && sum.load() == n * (n - 1) / 2, "MPMC queue delivers each item once");
+    }
+
+    // 3) Pool with a fake generator: fills to target, refills after pops, reports stats
+    {
+        atomic<uint32_t> next{1};
+        SafePrimePool pool({64, 128}, 4, 2, [&](int bits, const atomic<bool> &, BigInt &out)
+                           {
+                               out = BigInt(uint32_t(bits) * 100000u + next++);
+                               return true; });
+        expect_true(wait_until([&]
+                               {
+                                   auto st = pool.stats();
+                                   return st[0].ready == 4 && st[1].ready == 4; }),
+                    "pool fills every bit size to target");
+        set<string> seen;
+        bool ok = true;
+        for (int i = 0; i < 10; ++i)
+        {
+            BigInt p = pool.pop(64);
+            ok = ok && p.data[0] / 100000u == 64u;
+            seen.insert(p.to_decimal());
+        }
+        expect_true(ok && seen.size() == 10, "pop returns distinct values of the requested size");
+        expect_true(wait_until([&]
+                               { return pool.stats()[0].ready == 4; }),
+                    "pool refills after consumers pop");
+        auto st = pool.stats();
+        expect_true(st[0].generated >= 4 + st[0].popped && st[0].popped + st[0].misses >= 10 && st[0].rate > 0.0,
+                    "stats count generated/popped and rate");
+        bool threw = false;
+        try
+        {
+            pool.pop(96);
+        }
+        catch (const runtime_error &)
+        {
+            threw = true;
+        }
+        BigInt dummy;
+        expect_true(threw && !pool.try_pop(96, dummy), "unknown bit size rejected");
+    }
+
+    // 4) Pool with the real generator produces safe primes
+    {
+        SafePrimePool pool({32}, 1, 1);
+        BigInt p;
+        expect_true(wait_until([&]
+                               { return pool.try_pop(32, p); }),
+                    "background safe prime available");
+        BigInt q = (p - BigInt(1)).shr_bits(1);
+        expect_true(isPrime(p) && isPrime(q), "pooled value is a safe prime");
+    }
+
+    // 5) Destruction cancels generations in progress; a throwing generator is counted, not fatal
+    {
+        atomic<int> started{0};
+        auto t0 = chrono::steady_clock::now();
+        {
+            SafePrimePool pool({64}, 2, 2, [&](int, const atomic<bool> &cancel, BigInt &)
+                               {
+                                   ++started;
+                                   while (!cancel.load())
+                                       this_thread::sleep_for(chrono::milliseconds(1));
+                                   return false; });
+            wait_until([&]
+                       { return started.load() == 2; });
+            expect_true(pool.stats()[0].in_flight == 2, "both workers busy in the generator");
+        }
+        expect_true(chrono::steady_clock::now() - t0 < chrono::seconds(5), "destructor cancels blocked generators");
+
+        t0 = chrono::steady_clock::now();
+        {
+            SafePrimePool pool({2048}, 1, 1);
+            this_thread::sleep_for(chrono::milliseconds(50));
+        }
+        expect_true(chrono::steady_clock::now() - t0 < chrono::seconds(5),
+                    "destructor cancels a 2048-bit safe prime search");
+
+        SafePrimePool pool({64}, 1, 1, [](int, const atomic<bool> &, BigInt &) -> bool
+                           { throw runtime_error("generator failure"); });
+        expect_true(wait_until([&]
+                               { return pool.stats()[0].failed >= 2; }),
+                    "generator exceptions are caught and counted");
+        expect_true(wait_until([&]
+                               { return pool.stats()[0].in_flight == 0; }) &&
+                        pool.stats()[0].generated == 0,
+                    "in_flight released after a failure");
+        bool threw = false;
+        try
+        {
+            pool.pop(64);
+        }
+        catch (const runtime_error &)
+        {
+            threw = true;
+        }
+        expect_true(threw, "synchronous pop rethrows to the caller");
+    }
+
+    cout << "All safe prime pool tests passed.\n";
+    return 0;
+}